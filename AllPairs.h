@@ -0,0 +1,431 @@
+#ifndef _ALLPAIRS_H
+#define _ALLPAIRS_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "Graph.h"
+#include "Parallel.h"
+using namespace std;
+
+//*****************************************************************************************
+//Binary matrix layout (native byte order):
+//
+//    MatrixHeader
+//    int dist[nodes * nodes]      row-major travel costs, INT_MAX where unreachable
+//    int next[nodes * nodes]      first hop of each shortest path, -1 where unreachable
+//                                 (only present if hasNextHops is set)
+//*****************************************************************************************
+
+const char MATRIX_MAGIC[8] = {'S','P','M','A','T','R','I','X'};
+const uint32_t MATRIX_VERSION = 1;
+
+//********************************
+//Matrix Header Struct
+//********************************
+struct MatrixHeader{
+	char magic[8];                 //MATRIX_MAGIC
+	uint32_t version;              //MATRIX_VERSION
+	int32_t nodes;                 //the matrix is nodes x nodes
+	uint32_t hasNextHops;          //1 if the next-hop matrix follows the distances
+	uint32_t reserved;             //zero
+};
+
+
+//How DistanceMatrix::Compute fills the matrix
+enum AllPairsMethod{
+	ALLPAIRS_AUTO,                             //pick from the graph's density
+	ALLPAIRS_FLOYD_WARSHALL,                   //blocked Floyd-Warshall, O(n^3) whatever the edge count
+	ALLPAIRS_DIJKSTRA                          //one Dijkstra per source, O(n (m + n log n))
+};
+
+const int ALLPAIRS_BLOCK = 64;                 //Floyd-Warshall tile edge (a 64x64 int tile is 16 KiB)
+#ifdef __AVX2__                                //AUTO uses Floyd-Warshall once edges * DENSITY >= nodes^2
+const int ALLPAIRS_DENSITY = 8;
+#else
+const int ALLPAIRS_DENSITY = 1;                //without SIMD, Dijkstra wins on all but complete graphs
+#endif
+
+
+//********************************
+//Distance Matrix Class Header
+//********************************
+//Every shortest-path cost in a graph, in one contiguous row-major array. Rows are padded
+//to a whole number of Floyd-Warshall tiles; Row(i) and Stride() expose the raw layout.
+//Unreachable pairs are stored as UNREACHED, half of INT_MAX, so that adding two of them
+//can never overflow inside the min-plus kernel; Dist() reports them as INT_MAX. Real
+//distances share the int range with that sentinel, so they must stay below it: Compute
+//refuses a graph whose simple paths could cost UNREACHED (about 1.07 billion) or more.
+class DistanceMatrix{
+	int numNodes;                              //number of nodes in the graph
+	int stride;                                //ints per row, a multiple of ALLPAIRS_BLOCK
+	vector<int> dist;                          //dist[i*stride + j]: cost from i to j
+	vector<int> next;                          //next[i*stride + j]: first hop from i towards j (optional)
+
+	void Reset(int nodes, bool withNextHops);
+	static long long LongestSimplePath(const Graph &g);  //bound on every shortest path's cost
+	void FloydWarshall(const Graph &g, int threads);
+	void RepeatedDijkstra(const Graph &g, int threads);
+	void TightTrees(const Graph &g, int threads);  //next hops from finished distances
+	template<bool NEXT>
+	void Tile(int ib, int jb, int kb);         //relax tile (ib, jb) through the nodes of block kb
+
+public:
+	static constexpr int UNREACHED = INT_MAX / 2;
+
+	DistanceMatrix():numNodes(0),stride(0){};
+	bool Compute(Graph &g, bool withNextHops = false, AllPairsMethod method = ALLPAIRS_AUTO, int threads = 0);
+	int NumNodes() const { return numNodes; }
+	int Stride() const { return stride; }
+	bool HasNextHops() const { return !next.empty(); }
+	const int *Row(int i) const { return dist.data() + (size_t)i * stride; }
+	int Dist(int i, int j) const{                                       //cost from i to j (INT_MAX if unreachable)
+		int d = dist[(size_t)i * stride + j];
+		return d >= UNREACHED ? INT_MAX : d;
+	}
+	int NextHop(int i, int j) const { return next[(size_t)i * stride + j]; } //first hop from i towards j (-1 if none)
+	bool FindPath(int src, int dest, PathResult &result) const;         //walk the next-hop matrix
+	bool Save(const string &path) const;                                //dump to a binary file
+};
+
+
+//*****************************************************************************************
+//Function:     Compute
+//Purpose:      Fill the matrix for a graph. Floyd-Warshall touches every pair for every
+//              node, so it only wins when the graph is dense or small; AUTO switches to
+//              repeated Dijkstra when edges * ALLPAIRS_DENSITY < nodes^2.
+//Incoming:     g: the graph (frozen by this call)
+//              withNextHops: also record the first hop of every shortest path
+//              method: which algorithm to use
+//              threads: worker threads (0 for one per hardware thread)
+//Outgoing:     The matrix holds every distance (and next hop), or is empty on failure
+//Return:       Whether every distance fits below UNREACHED
+//*****************************************************************************************
+bool DistanceMatrix::Compute(Graph &g, bool withNextHops, AllPairsMethod method, int threads){
+	g.Freeze();
+	if(LongestSimplePath(g) >= UNREACHED){
+		cerr << "Err: paths in this graph can cost " << UNREACHED << " or more, too much for a distance matrix" << endl;
+		Reset(0, false);
+		return false;
+	}
+	Reset(g.NumNodes(), withNextHops);
+	threads = ThreadCount(threads);
+	if(method == ALLPAIRS_AUTO){
+		long long nodes = g.NumNodes();
+		method = (long long)g.NumEdges() * ALLPAIRS_DENSITY >= nodes * nodes ? ALLPAIRS_FLOYD_WARSHALL : ALLPAIRS_DIJKSTRA;
+	}
+	if(method == ALLPAIRS_FLOYD_WARSHALL)
+		FloydWarshall(g, threads);
+	else
+		RepeatedDijkstra(g, threads);
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Longest Simple Path
+//Purpose:      An upper bound on any shortest path's cost: a simple path leaves each node
+//              at most once, so it costs at most the sum of every node's heaviest
+//              outgoing edge, which is never looser than MaxWeight() * nodes.
+//Incoming:     g: the frozen graph
+//Outgoing:     N/A
+//Return:       The bound
+//*****************************************************************************************
+long long DistanceMatrix::LongestSimplePath(const Graph &g){
+	const int *offsets = g.Offsets();
+	const int *weights = g.Weights();
+	long long total = 0;
+	for(int u = 0; u < g.NumNodes(); u++){
+		int heaviest = 0;
+		for(int e = offsets[u]; e < offsets[u+1]; e++)
+			heaviest = max(heaviest, weights[e]);
+		total += heaviest;
+	}
+	return total;
+}
+
+
+//*****************************************************************************************
+//Function:     Reset
+//Purpose:      Size the matrix for a graph and mark every pair unreachable except each
+//              node to itself
+//Incoming:     nodes: number of nodes
+//              withNextHops: whether to keep a next-hop matrix
+//Outgoing:     Freshly initialized arrays
+//Return:       N/A-void function
+//*****************************************************************************************
+void DistanceMatrix::Reset(int nodes, bool withNextHops){
+	numNodes = nodes;
+	stride = (nodes + ALLPAIRS_BLOCK - 1) / ALLPAIRS_BLOCK * ALLPAIRS_BLOCK;
+	dist.assign((size_t)stride * stride, UNREACHED);
+	next.clear();
+	if(withNextHops)
+		next.assign((size_t)stride * stride, -1);
+	for(int i = 0; i < stride; i++){
+		dist[(size_t)i * stride + i] = 0;
+		if(withNextHops)
+			next[(size_t)i * stride + i] = i;
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Tile
+//Purpose:      The min-plus kernel: for every k in block kb, every i in block ib and every
+//              j in block jb, dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]).
+//              k is the outer loop, so the tile may overlap row or column block kb (the
+//              diagonal is 0, which makes those updates no-ops). With AVX2 the j loop
+//              handles eight columns per instruction; the next hop follows whichever
+//              lanes improved.
+//Incoming:     ib / jb: the tile to update
+//              kb: the block of intermediate nodes
+//              NEXT: also maintain the next-hop matrix
+//Outgoing:     The tile is relaxed
+//Return:       N/A-void function
+//*****************************************************************************************
+template<bool NEXT>
+void DistanceMatrix::Tile(int ib, int jb, int kb){
+	const int i0 = ib * ALLPAIRS_BLOCK, j0 = jb * ALLPAIRS_BLOCK, k0 = kb * ALLPAIRS_BLOCK;
+	for(int k = k0; k < k0 + ALLPAIRS_BLOCK; k++){
+		const int *rowK = dist.data() + (size_t)k * stride + j0;
+		for(int i = i0; i < i0 + ALLPAIRS_BLOCK; i++){
+			int *rowI = dist.data() + (size_t)i * stride;
+			const int ik = rowI[k];
+			if(ik >= UNREACHED)                        //nothing to gain through k
+				continue;
+			int *out = rowI + j0;
+			int *hop = NEXT ? next.data() + (size_t)i * stride + j0 : NULL;
+			const int hopK = NEXT ? next[(size_t)i * stride + k] : 0;
+#ifdef __AVX2__
+			const __m256i through = _mm256_set1_epi32(ik);
+			const __m256i hopThrough = _mm256_set1_epi32(hopK);
+			for(int j = 0; j < ALLPAIRS_BLOCK; j += 8){
+				__m256i current = _mm256_loadu_si256((const __m256i *)(out + j));
+				__m256i candidate = _mm256_add_epi32(through, _mm256_loadu_si256((const __m256i *)(rowK + j)));
+				if(NEXT){
+					__m256i better = _mm256_cmpgt_epi32(current, candidate);
+					__m256i hops = _mm256_loadu_si256((const __m256i *)(hop + j));
+					_mm256_storeu_si256((__m256i *)(hop + j), _mm256_blendv_epi8(hops, hopThrough, better));
+				}
+				_mm256_storeu_si256((__m256i *)(out + j), _mm256_min_epi32(current, candidate));
+			}
+#else
+			for(int j = 0; j < ALLPAIRS_BLOCK; j++){
+				int candidate = ik + rowK[j];
+				if(candidate < out[j]){
+					out[j] = candidate;
+					if(NEXT)
+						hop[j] = hopK;
+				}
+			}
+#endif
+		}
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Floyd Warshall
+//Purpose:      Cache-blocked Floyd-Warshall. For each block kb of intermediate nodes:
+//              the diagonal tile first, then every other tile in row kb and column kb
+//              (which only depend on the diagonal), then every remaining tile (which only
+//              depend on row kb and column kb). Tiles within the last two phases are
+//              independent and are spread across the threads.
+//Incoming:     g: the frozen graph
+//              threads: number of workers
+//Outgoing:     The whole matrix is filled
+//Return:       N/A-void function
+//*****************************************************************************************
+void DistanceMatrix::FloydWarshall(const Graph &g, int threads){
+	const int *offsets = g.Offsets();
+	const int *targets = g.Targets();
+	const int *weights = g.Weights();
+	bool withNext = HasNextHops();
+	bool zeroEdge = false;                     //does any edge weigh nothing?
+	for(int u = 0; u < numNodes; u++){         //seed the matrix with the edges
+		for(int e = offsets[u]; e < offsets[u+1]; e++){
+			size_t cell = (size_t)u * stride + targets[e];
+			zeroEdge = zeroEdge || weights[e] == 0;
+			if(weights[e] < dist[cell]){
+				dist[cell] = weights[e];
+				if(withNext)
+					next[cell] = targets[e];
+			}
+		}
+	}
+
+	bool kernelHops = withNext && !zeroEdge;
+	auto tile = [&](int ib, int jb, int kb){
+		if(kernelHops)
+			Tile<true>(ib, jb, kb);
+		else
+			Tile<false>(ib, jb, kb);
+	};
+	int blocks = stride / ALLPAIRS_BLOCK;
+	for(int kb = 0; kb < blocks; kb++){
+		tile(kb, kb, kb);
+		ParallelFor(2 * (blocks - 1), threads, [&](int t, int){  //row kb and column kb
+			int other = t / 2 < kb ? t / 2 : t / 2 + 1;
+			if(t % 2 == 0)
+				tile(kb, other, kb);
+			else
+				tile(other, kb, kb);
+		});
+		ParallelFor((blocks - 1) * (blocks - 1), threads, [&](int t, int){  //everything else
+			int ib = t / (blocks - 1), jb = t % (blocks - 1);
+			tile(ib < kb ? ib : ib + 1, jb < kb ? jb : jb + 1, kb);
+		});
+	}
+	if(withNext && !kernelHops)
+		TightTrees(g, threads);
+}
+
+
+//*****************************************************************************************
+//Function:     Tight Trees
+//Purpose:      Rebuild the next-hop matrix from finished distances. For each column j a
+//              breadth-first walk over reverse edges from j follows only "tight" edges
+//              u->x (weight + dist[x][j] == dist[u][j]) and points each newly found u at
+//              the x that found it. Every column is then a tree, so next hops cannot loop
+//              even around zero-weight cycles, where the blocked kernel's hops can.
+//Incoming:     g: the frozen graph
+//              threads: number of workers
+//Outgoing:     next holds a first hop for every reachable pair
+//Return:       N/A-void function
+//*****************************************************************************************
+void DistanceMatrix::TightTrees(const Graph &g, int threads){
+	const int *revOffsets = g.ReverseOffsets();
+	const int *revSources = g.ReverseSources();
+	const int *revWeights = g.ReverseWeights();
+	vector< vector<int> > queues(threads), toJ(threads), hops(threads);
+	ParallelFor(numNodes, threads, [&](int j, int t){
+		vector<int> &queue = queues[t];
+		vector<int> &column = toJ[t];              //column j copied out once, so the walk reads contiguous memory
+		vector<int> &hop = hops[t];
+		column.resize(numNodes);
+		hop.assign(numNodes, -1);
+		for(int i = 0; i < numNodes; i++)
+			column[i] = dist[(size_t)i * stride + j];
+		hop[j] = j;
+		queue.assign(1, j);
+		for(size_t head = 0; head < queue.size(); head++){
+			int x = queue[head];
+			for(int e = revOffsets[x]; e < revOffsets[x+1]; e++){
+				int u = revSources[e];
+				if(hop[u] < 0 && column[u] == revWeights[e] + column[x]){
+					hop[u] = x;
+					queue.push_back(u);
+				}
+			}
+		}
+		for(int i = 0; i < numNodes; i++)
+			next[(size_t)i * stride + j] = hop[i];
+	});
+}
+
+
+//*****************************************************************************************
+//Function:     Repeated Dijkstra
+//Purpose:      Fill the matrix one column at a time with a backward one-to-all search
+//              from each destination, destinations spread across the threads. A backward
+//              search from j leaves every node pointing at its next hop towards j, and
+//              because a whole column comes from one search tree, following next hops can
+//              never loop, not even around zero-weight cycles.
+//Incoming:     g: the frozen graph
+//              threads: number of workers
+//Outgoing:     The whole matrix is filled
+//Return:       N/A-void function
+//*****************************************************************************************
+void DistanceMatrix::RepeatedDijkstra(const Graph &g, int threads){
+	threads = min(threads, max(numNodes, 1));
+	vector<SearchState> states(threads);
+	bool withNext = HasNextHops();
+	ParallelFor(numNodes, threads, [&](int dest, int t){
+		SearchState &state = states[t];
+		g.Search(dest, NULL, 0, state, true);
+		for(int v = 0; v < numNodes; v++){
+			if(!state.Reached(v))
+				continue;
+			size_t cell = (size_t)v * stride + dest;
+			dist[cell] = state.distFromSrc[v];
+			if(withNext && v != dest)
+				next[cell] = state.changedby[v];
+		}
+	});
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path
+//Purpose:      Rebuild a shortest path by following first hops from src
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              result: receives the cost and the path
+//Outgoing:     result is filled in, or left unreachable if next hops were not kept
+//Return:       Whether dest is reachable from src and its path could be rebuilt
+//*****************************************************************************************
+bool DistanceMatrix::FindPath(int src, int dest, PathResult &result) const{
+	result.path.clear();
+	if(!HasNextHops()){                        //Compute was asked for distances only
+		result.cost = INT_MAX;
+		return false;
+	}
+	result.cost = Dist(src, dest);
+	if(!result.Found())
+		return false;
+	result.path.push_back(src);
+	for(int at = src; at != dest; ){
+		at = NextHop(at, dest);
+		result.path.push_back(at);
+	}
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Save
+//Purpose:      Write the matrix (without row padding) to a binary file, in the layout
+//              described at the top of this file
+//Incoming:     path: the file to write
+//Outgoing:     The matrix file
+//Return:       Whether the file was written
+//*****************************************************************************************
+bool DistanceMatrix::Save(const string &path) const{
+	MatrixHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MATRIX_MAGIC, sizeof(header.magic));
+	header.version = MATRIX_VERSION;
+	header.nodes = numNodes;
+	header.hasNextHops = HasNextHops() ? 1 : 0;
+
+	FILE *file = fopen(path.c_str(), "wb");
+	if(!file){
+		cerr << "Err: could not create matrix file \"" << path << "\"" << endl;
+		return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	vector<int> row(numNodes);
+	for(int i = 0; i < numNodes && ok; i++){
+		for(int j = 0; j < numNodes; j++)
+			row[j] = Dist(i, j);
+		ok = fwrite(row.data(), sizeof(int), numNodes, file) == (size_t)numNodes;
+	}
+	for(int i = 0; i < numNodes && ok && HasNextHops(); i++)
+		ok = fwrite(next.data() + (size_t)i * stride, sizeof(int), numNodes, file) == (size_t)numNodes;
+	if(fclose(file) != 0)
+		ok = false;
+	if(!ok)
+		cerr << "Err: could not write matrix file \"" << path << "\"" << endl;
+	return ok;
+}
+
+
+#endif
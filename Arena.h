@@ -0,0 +1,146 @@
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+using namespace std;
+
+//********************************
+//Arena Class Header
+//********************************
+//Bump allocator for short-lived build buffers. Memory is carved out of large chunks in
+//order and never handed back piece by piece; Reset (or the destructor) releases every
+//chunk at once. That turns the many growing buffers of a graph build into a handful of
+//big allocations, and frees them all in one go when the build is done.
+class Arena{
+	vector<char *> chunks;                     //every chunk obtained so far
+	char *cursor;                              //next free byte in the newest chunk
+	char *limit;                               //end of the newest chunk
+	size_t chunkSize;                          //size of an ordinary chunk
+	size_t used;                               //bytes handed out since the last Reset
+
+	void Grow(size_t bytes);                   //start a new chunk that fits "bytes"
+
+public:
+	explicit Arena(size_t chunk = 1 << 20):cursor(NULL),limit(NULL),chunkSize(chunk),used(0){};
+	~Arena(){ Reset(); }
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+	void *Allocate(size_t bytes, size_t align = alignof(max_align_t)); //carve out "bytes" bytes
+	void Reset();                              //release every chunk at once
+	size_t Used() const { return used; }       //bytes handed out since the last Reset
+	int Chunks() const { return (int)chunks.size(); } //chunks currently held
+};
+
+
+//*****************************************************************************************
+//Function:     Allocate
+//Purpose:      Hand out the next "bytes" bytes of the current chunk, starting a new chunk
+//              when it is full. Requests bigger than a chunk get a chunk of their own.
+//Incoming:     bytes: how much memory is needed
+//              align: the alignment it needs (a power of two)
+//Outgoing:     The cursor moves past the block
+//Return:       The block; it stays valid until Reset
+//*****************************************************************************************
+void *Arena::Allocate(size_t bytes, size_t align){
+	size_t pad = cursor ? (align - (size_t)cursor % align) % align : 0;
+	if(!cursor || pad + bytes > (size_t)(limit - cursor)){
+		Grow(bytes + align);
+		pad = (align - (size_t)cursor % align) % align;
+	}
+	char *block = cursor + pad;
+	cursor = block + bytes;
+	used += bytes;
+	return block;
+}
+
+
+void Arena::Grow(size_t bytes){
+	size_t size = bytes > chunkSize ? bytes : chunkSize;
+	char *chunk = (char *)malloc(size);
+	if(!chunk)
+		throw bad_alloc();
+	chunks.push_back(chunk);
+	cursor = chunk;
+	limit = chunk + size;
+}
+
+
+void Arena::Reset(){
+	for(size_t i = 0; i < chunks.size(); i++)
+		free(chunks[i]);
+	chunks.clear();
+	cursor = limit = NULL;
+	used = 0;
+}
+
+
+//********************************
+//Arena Allocator Class Header
+//********************************
+//Standard allocator that takes its memory from an Arena, so a vector can be used as a
+//build buffer. Deallocation does nothing; the arena releases everything together.
+template<class T>
+class ArenaAllocator{
+public:
+	typedef T value_type;
+	Arena *arena;                              //where the memory comes from
+
+	explicit ArenaAllocator(Arena *a):arena(a){};
+	template<class U>
+	ArenaAllocator(const ArenaAllocator<U> &other):arena(other.arena){};
+	T *allocate(size_t n){ return (T *)arena->Allocate(n * sizeof(T), alignof(T)); }
+	void deallocate(T *, size_t){}
+	template<class U>
+	bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+	template<class U>
+	bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+
+//*****************************************************************************************
+//Allocation counters. Building with -DCOUNT_ALLOCATIONS replaces the global operator
+//new/delete with versions that count every heap allocation in the program, which is
+//how we check that a warmed-up query allocates nothing. Like the rest of the library this
+//header must then be included in one translation unit only. Without the flag the
+//counters stay at zero and cost nothing.
+//*****************************************************************************************
+atomic<unsigned long long> heapAllocations(0);         //operator new calls so far
+atomic<unsigned long long> heapBytes(0);               //bytes requested from them
+
+#ifdef COUNT_ALLOCATIONS
+void *operator new(size_t bytes){
+	heapAllocations.fetch_add(1, memory_order_relaxed);
+	heapBytes.fetch_add(bytes, memory_order_relaxed);
+	void *block = malloc(bytes ? bytes : 1);
+	if(!block)
+		throw bad_alloc();
+	return block;
+}
+void *operator new[](size_t bytes){ return operator new(bytes); }
+[[gnu::noinline]] void operator delete(void *block) noexcept { free(block); }   //kept out of line so GCC does not
+void operator delete[](void *block) noexcept { operator delete(block); }       //pair an inlined free() with new
+void operator delete(void *block, size_t) noexcept { operator delete(block); }
+void operator delete[](void *block, size_t) noexcept { operator delete(block); }
+const bool ALLOCATIONS_COUNTED = true;
+#else
+const bool ALLOCATIONS_COUNTED = false;
+#endif
+
+
+//********************************
+//Allocation Scope Struct
+//********************************
+//Counts the heap allocations made between its construction and a call to Count()
+struct AllocationScope{
+	unsigned long long start;                  //heapAllocations when the scope began
+
+	AllocationScope():start(heapAllocations.load()){};
+	unsigned long long Count() const { return heapAllocations.load() - start; }
+};
+
+
+#endif
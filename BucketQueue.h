@@ -0,0 +1,209 @@
+#ifndef _BUCKETQUEUE_H
+#define _BUCKETQUEUE_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+using namespace std;
+
+//********************************
+//Bucket Queue class header
+//********************************
+//Monotone bucket queue for Dial's algorithm. When every edge weighs at most "span", a
+//Dijkstra frontier only ever holds distances in [d, d + span], where d is the distance
+//last dequeued, so span+1 circular buckets give every live distance a bucket of its own.
+//Each bucket is an intrusive doubly linked list threaded through per-node arrays, which
+//makes insert and decrease-key O(1); Dequeue walks the cursor forward to the next
+//non-empty bucket. Same Enqueue/Dequeue contract as IndexedPriorityQueue, with one extra
+//rule: no distance may be below the last one dequeued, and the queued distances must
+//always fit within "span" of each other.
+class BucketQueue{
+	vector<int> head;                  //first node in each bucket (-1 if empty)
+	vector<int> next;                  //next node in the same bucket (-1 at the end)
+	vector<int> prev;                  //previous node in the same bucket (-1 at the front, NOT_QUEUED if absent)
+	vector<int> keys;                  //distance of each queued node
+	int span;                          //largest gap between the smallest and largest queued distance
+	int size;                          //number of queued nodes
+	mutable int cursor;                //no queued distance is smaller than this
+	mutable int slot;                  //bucket of "cursor"
+
+	static constexpr int NOT_QUEUED = -2;
+
+	void Link(int index, int dist);                                     //add a node to the bucket for dist
+	void Unlink(int index);                                             //take a node out of its bucket
+	void Advance() const;                                               //move the cursor to the first non-empty bucket
+
+public:
+	BucketQueue():span(0),size(0),cursor(0),slot(0){ head.assign(1, -1); };
+	void SetSpan(int maxWeight);                                        //size the buckets for edges up to maxWeight
+	int Span() const { return span; }
+	void Reserve(int capacity);                                         //pre-size for node indices [0, capacity)
+	void Enqueue(int index, int dist);                                  //enqueue (insert or decrease)
+	int Dequeue(int &distance);                                         //dequeue (remove min)
+	bool Empty() const { return size == 0; }                            //is the queue empty?
+	int Size() const { return size; }                                   //number of queued nodes
+	int TopDistance() const;                                            //smallest queued distance
+	bool Contains(int index) const { return index < (int)prev.size() && prev[index] != NOT_QUEUED; } //is the node queued?
+	void Clear();                                                       //empty the queue, keeping its memory
+};
+
+
+//*****************************************************************************************
+//Function:     Set Span
+//Purpose:      Size the circular buckets for a graph whose heaviest edge is maxWeight.
+//              Only an empty queue may be resized; keeping the same span is free.
+//Incoming:     maxWeight: the largest edge weight the search will relax
+//Outgoing:     maxWeight+1 empty buckets
+//Return:       N/A-void function
+//*****************************************************************************************
+void BucketQueue::SetSpan(int maxWeight){
+	if(maxWeight == span)
+		return;
+	Clear();
+	span = max(maxWeight, 0);
+	head.assign(span + 1, -1);
+	slot = cursor % (span + 1);
+}
+
+
+//*****************************************************************************************
+//Function:     Reserve
+//Purpose:      Pre-size the per-node arrays so that node indices below "capacity" never
+//              cause a reallocation while searching
+//Incoming:     capacity: one past the largest node index that will be enqueued
+//Outgoing:     Per-node arrays grown to fit
+//Return:       N/A-void function
+//*****************************************************************************************
+void BucketQueue::Reserve(int capacity){
+	if(capacity > (int)prev.size()){
+		next.resize(capacity, -1);
+		prev.resize(capacity, NOT_QUEUED);
+		keys.resize(capacity, 0);
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Link / Unlink
+//Purpose:      Push a node onto the front of its distance's bucket, or remove it from
+//              whichever bucket holds it
+//Incoming:     index: the node
+//              dist: its distance (Link only)
+//Outgoing:     Updated bucket lists
+//Return:       N/A-void function
+//*****************************************************************************************
+void BucketQueue::Link(int index, int dist){
+	int b = dist % (span + 1);
+	keys[index] = dist;
+	prev[index] = -1;
+	next[index] = head[b];
+	if(head[b] >= 0)
+		prev[head[b]] = index;
+	head[b] = index;
+}
+
+void BucketQueue::Unlink(int index){
+	if(prev[index] >= 0)
+		next[prev[index]] = next[index];
+	else
+		head[keys[index] % (span + 1)] = next[index];
+	if(next[index] >= 0)
+		prev[next[index]] = prev[index];
+	prev[index] = NOT_QUEUED;
+}
+
+
+//*****************************************************************************************
+//Function:     Enqueue (Insert Function)
+//Purpose:      Insert a node, or move an already queued node to a strictly smaller
+//              distance. Both are O(1). A distance below the cursor pulls the cursor
+//              back to it, which is safe because everything queued is still within span.
+//Incoming:     index: the index of the node being enqueued
+//              dist: its distance (see the class comment for the allowed range)
+//Outgoing:     The node sits in the bucket for dist
+//Return:       N/A-void function
+//*****************************************************************************************
+void BucketQueue::Enqueue(int index, int dist){
+	if(index >= (int)prev.size())              //grow the per-node arrays if this index has never been seen
+		Reserve(max(index + 1, 2 * (int)prev.size()));
+
+	if(prev[index] != NOT_QUEUED){             //already queued: only a smaller distance moves it
+		if(dist >= keys[index])
+			return;
+		Unlink(index);
+		size--;
+	}
+	if(size == 0 || dist < cursor){            //the new node is the smallest: start the cursor there
+		cursor = dist;
+		slot = dist % (span + 1);
+	}
+	Link(index, dist);
+	size++;
+}
+
+
+//*****************************************************************************************
+//Function:     Advance
+//Purpose:      Walk the cursor forward to the first non-empty bucket. The cursor never
+//              moves backwards, so a whole search walks each distance at most once.
+//Incoming:     N/A
+//Outgoing:     cursor / slot point at the smallest queued distance (queue must not be empty)
+//Return:       N/A-void function
+//*****************************************************************************************
+void BucketQueue::Advance() const{
+	while(head[slot] < 0){
+		cursor++;
+		if(++slot > span)
+			slot = 0;
+	}
+}
+
+
+int BucketQueue::TopDistance() const{
+	if(size == 0)
+		return INT_MAX;
+	Advance();
+	return cursor;
+}
+
+
+//*****************************************************************************************
+//Function:     Dequeue (Remove Min Function)
+//Purpose:      Remove a node with the smallest distance
+//Incoming:     &distance: receives the distance of the dequeued node
+//Outgoing:     Updated queue with the node removed
+//Return:       The index of the removed node, or INT_MIN if the queue was empty
+//*****************************************************************************************
+int BucketQueue::Dequeue(int &distance){
+	if(size == 0)
+		return INT_MIN;
+	Advance();
+	int index = head[slot];
+	Unlink(index);
+	size--;
+	distance = cursor;
+	return index;
+}
+
+
+//*****************************************************************************************
+//Function:     Clear
+//Purpose:      Remove every node from the queue. Buckets are walked from the cursor only
+//              until every queued node has been found, so the cost is at most the size
+//              plus the number of buckets.
+//Incoming:     N/A
+//Outgoing:     Empty queue; the arrays keep their capacity
+//Return:       N/A-void function
+//*****************************************************************************************
+void BucketQueue::Clear(){
+	for(int b = slot; size > 0; b = (b == span ? 0 : b + 1)){
+		for(int index = head[b]; index >= 0; index = next[index]){
+			prev[index] = NOT_QUEUED;
+			size--;
+		}
+		head[b] = -1;
+	}
+}
+
+
+#endif
@@ -0,0 +1,531 @@
+#ifndef _CONTRACTIONHIERARCHY_H
+#define _CONTRACTIONHIERARCHY_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include "Graph.h"
+#include "Parallel.h"
+using namespace std;
+
+//********************************
+//Hierarchy State Struct
+//********************************
+//Scratch state for one Contraction Hierarchies query; reuse it across queries.
+struct HierarchyState{
+	SearchState fwd;                           //upward search from the source
+	SearchState bwd;                           //upward search from the destination
+	vector<int> chain;                         //hierarchy nodes on the path
+	vector<int> stack;                         //shortcuts waiting to be unpacked
+};
+
+
+//********************************
+//Contraction Hierarchy Class Header
+//********************************
+//Offline preprocessing that contracts nodes one by one, least important first, adding
+//shortcut edges that preserve every shortest path among the nodes that remain. A query
+//then only follows edges towards more important nodes from both ends, which settles a
+//tiny fraction of the graph. Shortcuts remember the node they bypass, so a path found in
+//the hierarchy can be unpacked back into original edges.
+class ContractionHierarchy{
+	//********************************
+	//Arc Struct Implementation
+	//********************************
+	struct Arc{
+		int node;          //the other end of the edge
+		int wt;            //Weight
+		int middle;        //node a shortcut bypasses (-1 for an original edge)
+
+		Arc():node(-1),wt(0),middle(-1){};
+		Arc(int n, int weight, int mid):node(n),wt(weight),middle(mid){};
+	};
+
+	//********************************
+	//Shortcut Struct Implementation
+	//********************************
+	struct Shortcut{
+		int from;          //tail of the shortcut
+		int to;            //head of the shortcut
+		int wt;            //Weight
+		int middle;        //the contracted node it bypasses
+
+		Shortcut(int f, int t, int weight, int mid):from(f),to(t),wt(weight),middle(mid){};
+	};
+
+//**************************************************
+//Contraction Hierarchy Private Data Members
+//**************************************************
+	int numNodes;                              //number of nodes in the graph
+	int witnessLimit;                          //most nodes a contraction witness search may settle
+	vector<int> rank;                          //contraction order of each node (higher = more important)
+
+	vector<int> upOffsets;                     //CSR of edges u->v with rank[v] > rank[u], filed under u
+	vector<int> upNodes;
+	vector<int> upWeights;
+	vector<int> upMiddles;
+	vector<int> downOffsets;                   //CSR of edges u->v with rank[u] > rank[v], filed under v
+	vector<int> downNodes;                     //(downNodes holds u)
+	vector<int> downWeights;
+	vector<int> downMiddles;
+
+	//contraction-time working graph
+	vector< vector<Arc> > out;                 //remaining out-edges of each uncontracted node
+	vector< vector<Arc> > in;                  //remaining in-edges of each uncontracted node
+
+	void Build(const Graph &g, int threads);
+	void AddArc(int from, int to, int wt, int middle);
+	int FindShortcuts(int v, int settleLimit, SearchState &state, vector<Shortcut> *shortcuts,
+	                  const vector<char> *skip) const;
+	int Priority(int v, int deletedNeighbors, SearchState &state) const;
+	int FindArc(const vector<int> &offs, const vector<int> &nodes, const vector<int> &middles,
+	            int row, int node) const;
+	void Unpack(int from, int to, int middle, vector<int> &path, vector<int> &stack) const;
+
+//********************************
+//Contraction Hierarchy Public Functions
+//********************************
+public:
+	ContractionHierarchy(Graph &g, int threads = 0, int witnessSettleLimit = 500);
+	int NumNodes() const { return numNodes; }
+	int NumArcs() const { return (int)(upNodes.size() + downNodes.size()); }  //edges in the hierarchy
+	int Rank(int node) const { return rank[node]; }
+	int Search(int src, int dest, HierarchyState &state, int &cost) const;    //returns the meeting node
+	bool FindPath(int src, int dest, HierarchyState &state, PathResult &result) const;
+};
+
+
+//*****************************************************************************************
+//Function:     Contraction Hierarchy constructor
+//Purpose:      Preprocess a graph into a hierarchy
+//Incoming:     g: the graph (frozen by this call); the hierarchy does not keep a reference
+//              threads: workers for the contraction (0 for one per hardware thread)
+//              witnessSettleLimit: most nodes a witness search may settle before it
+//                  gives up and keeps the shortcut (smaller builds faster, larger adds
+//                  fewer shortcuts)
+//Outgoing:     A hierarchy ready to answer queries
+//Return:       N/A
+//*****************************************************************************************
+ContractionHierarchy::ContractionHierarchy(Graph &g, int threads, int witnessSettleLimit)
+	:numNodes(0),witnessLimit(witnessSettleLimit){
+	g.Freeze();
+	Build(g, ThreadCount(threads));
+}
+
+
+//*****************************************************************************************
+//Function:     Add Arc
+//Purpose:      Add an edge to the working graph, keeping only the cheapest edge between
+//              any ordered pair of nodes
+//Incoming:     from / to: the edge's ends
+//              wt: its weight
+//              middle: the node it bypasses (-1 for an original edge)
+//Outgoing:     out[from] and in[to] are updated
+//Return:       N/A-void function
+//*****************************************************************************************
+void ContractionHierarchy::AddArc(int from, int to, int wt, int middle){
+	vector<Arc> &row = out[from];
+	for(size_t i = 0; i < row.size(); i++){
+		if(row[i].node == to){                     //already connected: keep the cheaper edge
+			if(wt < row[i].wt){
+				row[i] = Arc(to, wt, middle);
+				vector<Arc> &back = in[to];
+				for(size_t j = 0; j < back.size(); j++)
+					if(back[j].node == from)
+						back[j] = Arc(from, wt, middle);
+			}
+			return;
+		}
+	}
+	row.push_back(Arc(to, wt, middle));
+	in[to].push_back(Arc(from, wt, middle));
+}
+
+
+//*****************************************************************************************
+//Function:     Find Shortcuts
+//Purpose:      Work out which shortcuts contracting v would need. For every in-neighbor
+//              u, a bounded Dijkstra from u that avoids v looks for a "witness" path to
+//              each out-neighbor w that is no longer than u->v->w; where none is found
+//              the shortcut u->w is required. Each search stops as soon as every
+//              out-neighbor is settled, or after settleLimit nodes.
+//Incoming:     v: the node to contract
+//              settleLimit: most nodes one witness search may settle
+//              state: the calling thread's scratch state
+//              shortcuts: receives the shortcuts (NULL to only count them)
+//              skip: nodes contracted alongside v, or NULL. Witnesses may not pass
+//                    through them: two nodes could otherwise each rely on a witness
+//                    through the other and lose both paths when contracted together.
+//Outgoing:     shortcuts is appended to
+//Return:       The number of shortcuts needed
+//*****************************************************************************************
+int ContractionHierarchy::FindShortcuts(int v, int settleLimit, SearchState &state, vector<Shortcut> *shortcuts,
+                                       const vector<char> *skip) const{
+	const vector<Arc> &ins = in[v];
+	const vector<Arc> &outs = out[v];
+	int needed = 0;
+	for(size_t i = 0; i < ins.size(); i++){
+		int u = ins[i].node;
+		int limit = 0;                             //longest path through v we must cover
+		int targets = 0;                           //out-neighbors the witness search still has to settle
+		state.Prepare(numNodes);
+		for(size_t j = 0; j < outs.size(); j++){
+			int w = outs[j].node;
+			if(w != u && !state.wanted[w]){
+				limit = max(limit, ins[i].wt + outs[j].wt);
+				state.wanted[w] = 1;
+				targets++;
+			}
+		}
+		if(targets == 0)
+			continue;                              //nothing to connect u to
+
+		state.Label(u, 0, INT_MIN);                //witness search from u, never passing through v
+		int eye = u, eyedist = 0, settled = 0;
+		while(eye != INT_MIN && eyedist <= limit && settled++ < settleLimit){
+			if(state.wanted[eye]){                     //settled one of the targets
+				state.wanted[eye] = 0;
+				if(--targets == 0)
+					break;
+			}
+			const vector<Arc> &arcs = out[eye];
+			for(size_t k = 0; k < arcs.size(); k++){
+				int adj = arcs[k].node;
+				int dist = eyedist + arcs[k].wt;
+				if(adj == v || dist > limit || (skip && (*skip)[adj]))
+					continue;
+				if(!state.Reached(adj) || dist < state.distFromSrc[adj]){
+					state.Label(adj, dist, eye);
+					state.pq.Enqueue(adj, dist);
+				}
+			}
+			eye = state.pq.Dequeue(eyedist);
+		}
+		for(size_t j = 0; j < outs.size(); j++)    //leave "wanted" clear for the next search
+			state.wanted[outs[j].node] = 0;
+
+		for(size_t j = 0; j < outs.size(); j++){
+			int w = outs[j].node;
+			int through = ins[i].wt + outs[j].wt;
+			if(w == u || state.Dist(w) <= through)     //u->w never needs v, or a witness is as short
+				continue;
+			needed++;
+			if(shortcuts)
+				shortcuts->push_back(Shortcut(u, w, through, v));
+		}
+	}
+	return needed;
+}
+
+
+//*****************************************************************************************
+//Function:     Priority
+//Purpose:      How late v should be contracted: its edge difference (shortcuts added
+//              minus edges removed) plus how many of its neighbors are already gone,
+//              which keeps the contraction spread evenly over the graph. Priorities are
+//              re-rated constantly, so they use a much shorter witness search than the
+//              real contraction; overcounting shortcuts here only delays a node.
+//Incoming:     v: the node to rate
+//              deletedNeighbors: neighbors of v contracted so far
+//              state: the calling thread's scratch state
+//Outgoing:     N/A
+//Return:       The priority (lower is contracted sooner)
+//*****************************************************************************************
+int ContractionHierarchy::Priority(int v, int deletedNeighbors, SearchState &state) const{
+	int added = FindShortcuts(v, max(1, witnessLimit / 10), state, NULL, NULL);
+	int removed = (int)(in[v].size() + out[v].size());
+	return 2 * (added - removed) + deletedNeighbors;
+}
+
+
+//*****************************************************************************************
+//Function:     Build
+//Purpose:      Contract the whole graph. Each round picks an independent set of nodes
+//              (every one has a lower priority than all of its neighbors), finds their
+//              shortcuts in parallel, contracts them together, and re-rates only the
+//              neighbors that changed. The edges each node still has when it is contracted
+//              all lead to more important nodes, so they become its upward edges.
+//Incoming:     g: the frozen graph
+//              threads: number of workers
+//Outgoing:     rank and the upward/downward CSR arrays are filled in
+//Return:       N/A-void function
+//*****************************************************************************************
+void ContractionHierarchy::Build(const Graph &g, int threads){
+	numNodes = g.NumNodes();
+	int n = numNodes;
+	out.assign(n, vector<Arc>());
+	in.assign(n, vector<Arc>());
+	const int *offsets = g.Offsets();
+	const int *targets = g.Targets();
+	const int *weights = g.Weights();
+	for(int u = 0; u < n; u++)
+		for(int e = offsets[u]; e < offsets[u+1]; e++)
+			if(targets[e] != u)                    //self loops never lie on a shortest path
+				AddArc(u, targets[e], weights[e], -1);
+
+	vector<SearchState> states(threads);       //one witness scratch state per worker
+	vector< vector<Shortcut> > found(threads); //shortcuts each worker found this round
+	vector<int> priority(n), deleted(n, 0);
+	vector< vector<Arc> > upArcs(n), downArcs(n);
+	rank.assign(n, -1);
+
+	vector<int> remaining(n);
+	for(int v = 0; v < n; v++)
+		remaining[v] = v;
+	ParallelFor(n, threads, [&](int i, int t){ priority[i] = Priority(i, 0, states[t]); });
+
+	auto before = [&](int a, int b){           //strict order: priority, then index
+		return priority[a] < priority[b] || (priority[a] == priority[b] && a < b);
+	};
+
+	int nextRank = 0;
+	vector<int> batch, touched;
+	vector<char> mark(n, 0), inBatch(n, 0);
+	while(!remaining.empty()){
+		batch.clear();                             //pick an independent set of local minima
+		for(size_t i = 0; i < remaining.size(); i++){
+			int v = remaining[i];
+			bool minimal = true;
+			for(size_t k = 0; k < out[v].size() && minimal; k++)
+				minimal = before(v, out[v][k].node);
+			for(size_t k = 0; k < in[v].size() && minimal; k++)
+				minimal = before(v, in[v][k].node);
+			if(minimal)
+				batch.push_back(v);
+		}
+
+		for(int t = 0; t < threads; t++)
+			found[t].clear();
+		for(size_t i = 0; i < batch.size(); i++)
+			inBatch[batch[i]] = 1;
+		ParallelFor((int)batch.size(), threads, [&](int i, int t){ FindShortcuts(batch[i], witnessLimit, states[t], &found[t], &inBatch); });
+
+		touched.clear();
+		for(size_t i = 0; i < batch.size(); i++){  //contract the set
+			int v = batch[i];
+			rank[v] = nextRank++;
+			inBatch[v] = 0;
+			upArcs[v].swap(out[v]);                    //everything left is more important than v
+			downArcs[v].swap(in[v]);
+			for(size_t k = 0; k < upArcs[v].size(); k++){
+				int w = upArcs[v][k].node;
+				vector<Arc> &back = in[w];
+				for(size_t j = 0; j < back.size(); j++)
+					if(back[j].node == v){ back[j] = back.back(); back.pop_back(); break; }
+				deleted[w]++;
+				if(!mark[w]){ mark[w] = 1; touched.push_back(w); }
+			}
+			for(size_t k = 0; k < downArcs[v].size(); k++){
+				int u = downArcs[v][k].node;
+				vector<Arc> &fwd = out[u];
+				for(size_t j = 0; j < fwd.size(); j++)
+					if(fwd[j].node == v){ fwd[j] = fwd.back(); fwd.pop_back(); break; }
+				deleted[u]++;
+				if(!mark[u]){ mark[u] = 1; touched.push_back(u); }
+			}
+		}
+		for(int t = 0; t < threads; t++)           //then wire in the shortcuts
+			for(size_t i = 0; i < found[t].size(); i++)
+				AddArc(found[t][i].from, found[t][i].to, found[t][i].wt, found[t][i].middle);
+
+		size_t kept = 0;                           //drop the contracted nodes
+		for(size_t i = 0; i < remaining.size(); i++)
+			if(rank[remaining[i]] < 0)
+				remaining[kept++] = remaining[i];
+		remaining.resize(kept);
+
+		ParallelFor((int)touched.size(), threads, [&](int i, int t){
+			int w = touched[i];
+			if(rank[w] < 0)
+				priority[w] = Priority(w, deleted[w], states[t]);
+		});
+		for(size_t i = 0; i < touched.size(); i++)
+			mark[touched[i]] = 0;
+	}
+	vector< vector<Arc> >().swap(out);         //the working graph is no longer needed
+	vector< vector<Arc> >().swap(in);
+
+	upOffsets.assign(n + 1, 0);                //pack the upward and downward edges into CSR
+	downOffsets.assign(n + 1, 0);
+	for(int v = 0; v < n; v++){
+		upOffsets[v+1] = upOffsets[v] + (int)upArcs[v].size();
+		downOffsets[v+1] = downOffsets[v] + (int)downArcs[v].size();
+	}
+	auto byNode = [](const Arc &a, const Arc &b){ return a.node < b.node; };
+	for(int v = 0; v < n; v++){
+		sort(upArcs[v].begin(), upArcs[v].end(), byNode);      //sorted rows let FindArc binary search
+		sort(downArcs[v].begin(), downArcs[v].end(), byNode);
+		for(size_t k = 0; k < upArcs[v].size(); k++){
+			upNodes.push_back(upArcs[v][k].node);
+			upWeights.push_back(upArcs[v][k].wt);
+			upMiddles.push_back(upArcs[v][k].middle);
+		}
+		for(size_t k = 0; k < downArcs[v].size(); k++){
+			downNodes.push_back(downArcs[v][k].node);
+			downWeights.push_back(downArcs[v][k].wt);
+			downMiddles.push_back(downArcs[v][k].middle);
+		}
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Search
+//Purpose:      Bidirectional Dijkstra that only climbs the hierarchy: the forward search
+//              from src follows upward edges, the backward search from dest follows
+//              downward edges in reverse. A node is "stalled" (not expanded) when a more
+//              important neighbor already offers a shorter way to it, since it cannot be
+//              on a shortest path then. The search stops once both queue minimums are at
+//              least the best meeting found.
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              state: the query's scratch state
+//              &cost: receives the length of the shortest path (INT_MAX if none)
+//Outgoing:     state.fwd / state.bwd hold the two search trees
+//Return:       The node where the best path peaks, or -1 if dest is unreachable
+//*****************************************************************************************
+int ContractionHierarchy::Search(int src, int dest, HierarchyState &state, int &cost) const{
+	SearchState &fwd = state.fwd, &bwd = state.bwd;
+	fwd.Prepare(numNodes);
+	bwd.Prepare(numNodes);
+	fwd.Label(src, 0, INT_MIN);
+	bwd.Label(dest, 0, INT_MIN);
+	fwd.pq.Enqueue(src, 0);
+	bwd.pq.Enqueue(dest, 0);
+
+	long long best = INT_MAX;
+	int meet = -1;
+	while(min(fwd.pq.TopDistance(), bwd.pq.TopDistance()) < best){
+		bool forward = fwd.pq.TopDistance() <= bwd.pq.TopDistance();
+		SearchState &side = forward ? fwd : bwd;
+		SearchState &other = forward ? bwd : fwd;
+		const vector<int> &offs = forward ? upOffsets : downOffsets;     //edges this side climbs
+		const vector<int> &nodes = forward ? upNodes : downNodes;
+		const vector<int> &wts = forward ? upWeights : downWeights;
+		const vector<int> &stallOffs = forward ? downOffsets : upOffsets; //edges arriving from above
+		const vector<int> &stallNodes = forward ? downNodes : upNodes;
+		const vector<int> &stallWts = forward ? downWeights : upWeights;
+
+		int eyedist;
+		int eye = side.pq.Dequeue(eyedist);
+		if(other.Reached(eye) && eyedist + (long long)other.distFromSrc[eye] < best){
+			best = eyedist + (long long)other.distFromSrc[eye];
+			meet = eye;
+		}
+
+		bool stalled = false;                      //stall-on-demand
+		for(int e = stallOffs[eye]; e < stallOffs[eye+1] && !stalled; e++){
+			int x = stallNodes[e];
+			stalled = side.Reached(x) && side.distFromSrc[x] + (long long)stallWts[e] < eyedist;
+		}
+		if(stalled)
+			continue;
+
+		for(int e = offs[eye]; e < offs[eye+1]; e++){
+			int adj = nodes[e];
+			int dist = eyedist + wts[e];
+			if(!side.Reached(adj) || dist < side.distFromSrc[adj]){
+				side.Label(adj, dist, eye);
+				side.pq.Enqueue(adj, dist);
+			}
+		}
+	}
+
+	cost = meet >= 0 ? (int)best : INT_MAX;
+	return meet;
+}
+
+
+//*****************************************************************************************
+//Function:     Find Arc
+//Purpose:      Find the hierarchy edge between a CSR row and a given node (rows are
+//              sorted by node, so this is a binary search)
+//Incoming:     offs / nodes / middles: one of the two CSR arrays
+//              row: the node whose row to scan
+//              node: the other end of the edge
+//Outgoing:     N/A
+//Return:       The edge's middle node (-1 for an original edge)
+//*****************************************************************************************
+int ContractionHierarchy::FindArc(const vector<int> &offs, const vector<int> &nodes, const vector<int> &middles,
+                                  int row, int node) const{
+	const int *first = nodes.data() + offs[row];
+	const int *last = nodes.data() + offs[row+1];
+	const int *found = lower_bound(first, last, node);
+	return found != last && *found == node ? middles[found - nodes.data()] : -1;
+}
+
+
+//*****************************************************************************************
+//Function:     Unpack
+//Purpose:      Expand one hierarchy edge into original edges, appending every node after
+//              "from" to the path. A shortcut from->to around m is the pair of edges
+//              from->m and m->to; m was contracted before both ends, so from->m is filed
+//              as a downward edge of m and m->to as an upward edge of m. An explicit stack
+//              replaces recursion so deep shortcut nests cannot overflow the call stack.
+//Incoming:     from / to / middle: the hierarchy edge
+//              path: the path being built
+//              stack: scratch space
+//Outgoing:     path is appended to
+//Return:       N/A-void function
+//*****************************************************************************************
+void ContractionHierarchy::Unpack(int from, int to, int middle, vector<int> &path, vector<int> &stack) const{
+	stack.clear();
+	stack.push_back(from);
+	stack.push_back(to);
+	stack.push_back(middle);
+	while(!stack.empty()){
+		int m = stack.back(); stack.pop_back();
+		int b = stack.back(); stack.pop_back();
+		int a = stack.back(); stack.pop_back();
+		if(m < 0){                                 //an original edge: b is the next stop
+			path.push_back(b);
+			continue;
+		}
+		stack.push_back(m);                        //second half, handled after the first
+		stack.push_back(b);
+		stack.push_back(FindArc(upOffsets, upNodes, upMiddles, m, b));
+		stack.push_back(a);                        //first half
+		stack.push_back(m);
+		stack.push_back(FindArc(downOffsets, downNodes, downMiddles, m, a));
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path
+//Purpose:      Answer a query and unpack the result into original nodes
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              state: the query's scratch state
+//              result: receives the cost and the path
+//Outgoing:     result is filled in
+//Return:       Whether dest is reachable from src
+//*****************************************************************************************
+bool ContractionHierarchy::FindPath(int src, int dest, HierarchyState &state, PathResult &result) const{
+	int meet = Search(src, dest, state, result.cost);
+	result.path.clear();
+	if(meet < 0)
+		return false;
+
+	vector<int> &chain = state.chain;          //hierarchy nodes from src up to the peak and down to dest
+	chain.clear();
+	for(int location = meet; location != INT_MIN; location = state.fwd.ChangedBy(location))
+		chain.push_back(location);
+	reverse(chain.begin(), chain.end());
+	int climb = (int)chain.size();             //chain[0, climb) went up; the rest comes down
+	for(int location = state.bwd.ChangedBy(meet); location != INT_MIN; location = state.bwd.ChangedBy(location))
+		chain.push_back(location);
+
+	result.path.push_back(src);
+	for(size_t i = 0; i + 1 < chain.size(); i++){
+		int a = chain[i], b = chain[i+1];
+		int middle = (int)i + 1 < climb
+		           ? FindArc(upOffsets, upNodes, upMiddles, a, b)       //a->b climbs: filed under a
+		           : FindArc(downOffsets, downNodes, downMiddles, b, a); //a->b descends: filed under b
+		Unpack(a, b, middle, result.path, state.stack);
+	}
+	return true;
+}
+
+
+#endif
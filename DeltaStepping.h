@@ -0,0 +1,416 @@
+#ifndef _DELTASTEPPING_H
+#define _DELTASTEPPING_H
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Graph.h"
+#include "Parallel.h"
+using namespace std;
+
+//********************************
+//Delta Stepping Class Header
+//********************************
+//Parallel one-to-all shortest paths (Meyer and Sanders' delta-stepping). Tentative
+//distances are grouped into buckets "delta" wide and the lowest non-empty bucket is
+//processed by every thread at once. Edges no heavier than delta ("light") can land back
+//in the same bucket, so they are relaxed round after round until the bucket stays empty;
+//heavier edges can only reach later buckets, so each settled node relaxes them once.
+//
+//Each node's distance and predecessor are packed into one 64-bit word and lowered with
+//compare-and-swap, so a relaxation never takes a lock. Every thread keeps its own bucket
+//lists of improved nodes, which are merged into the shared frontier between rounds.
+//The helper threads are started once and sleep between runs, as QueryPool's do.
+//
+//Distances match Dijkstra's exactly. Where two shortest paths tie, the predecessor kept
+//may differ from the one a sequential search would pick, but it is always on a shortest
+//path, so Graph::BuildPath still returns a valid path of the same cost.
+class DeltaStepping{
+	//********************************
+	//Worker Struct Implementation
+	//********************************
+	struct Worker{
+		vector< vector<int> > bins;                //nodes this thread improved, by bucket
+		vector<int> settled;                       //nodes this thread scanned in the current bucket
+		size_t copyAt;                             //where this thread's bucket goes in the frontier
+	};
+
+//**************************************************
+//Delta Stepping Private Data Members
+//**************************************************
+	const Graph &graph;                        //the graph being searched (frozen)
+	int numNodes;                              //number of nodes in the graph
+	int delta;                                 //bucket width
+	int threads;                               //number of threads in a run
+	Barrier barrier;                           //where the whole team meets between rounds
+	vector<int> targets;                       //graph adjacency with each row reordered light edges first
+	vector<int> weights;                       //weight of each edge, parallel to targets
+	vector<int> heavyStart;                    //first heavy edge of each row
+	unique_ptr< atomic<uint64_t>[] > labels;   //packed (distance, predecessor) of each node
+	unique_ptr< atomic<unsigned char>[] > scanned; //is the node on some worker's settled list?
+
+	vector<Worker> workers;                    //per-thread buffers, kept between runs
+	vector<int> frontier;                      //nodes of the bucket being processed
+	atomic<size_t> cursor;                     //next frontier entry to hand out
+	int bin;                                   //index of the bucket being processed
+	bool heavyNext;                            //the bucket is empty: relax heavy edges next
+	bool finished;                             //no bucket is left
+
+	vector<thread> helpers;                    //threads 1 .. threads-1, kept between runs
+	mutex lock;                                //guards job, helpersDone and stopping
+	condition_variable wake;                   //signalled when a run starts
+	condition_variable done;                   //signalled when the last helper finishes a run
+	int job;                                   //number of runs started so far
+	int helpersDone;                           //helpers finished with the current run
+	bool stopping;                             //set when the engine is being destroyed
+	int runSrc;                                //source of the current run
+	SearchState *runState;                     //where the current run writes its answer
+
+	static constexpr uint32_t NO_PRED = 0xFFFFFFFFu;
+	static uint64_t Pack(int dist, uint32_t pred){ return ((uint64_t)(uint32_t)dist << 32) | pred; }
+	static int DistOf(uint64_t label){ return (int)(label >> 32); }
+	static int PredOf(uint64_t label){ return (uint32_t)label == NO_PRED ? INT_MIN : (int)(uint32_t)label; }
+
+	void Partition();                          //split every row into light and heavy edges
+	void Relax(Worker &me, int u, int dist, int v);
+	void HelperLoop(int id);                   //body of each helper thread
+	void Work(int id);                         //one thread's part of the current run
+	void PlanNextBin();                        //find the lowest non-empty bucket across workers
+	void SizeFrontier();                       //lay this bucket's per-thread lists out in the frontier
+
+//********************************
+//Delta Stepping Public Functions
+//********************************
+public:
+	DeltaStepping(Graph &g, int bucketWidth = 0, int threadCount = 0);
+	~DeltaStepping();
+	DeltaStepping(const DeltaStepping &) = delete;
+	DeltaStepping &operator=(const DeltaStepping &) = delete;
+	int Delta() const { return delta; }
+	int Threads() const { return threads; }
+	void SetDelta(int bucketWidth);            //re-tune the bucket width (0 picks one from the graph)
+	void Run(int src, SearchState &state);     //one-to-all distances from src into state
+};
+
+
+//*****************************************************************************************
+//Function:     Delta Stepping constructor
+//Purpose:      Freeze the graph, prepare the light/heavy edge split and start the
+//              helper threads
+//Incoming:     g: the graph to search; it must not change while this object is used
+//              bucketWidth: delta (0 picks one from the graph, see SetDelta)
+//              threadCount: threads per run (0 for one per hardware thread)
+//Outgoing:     An engine ready to Run
+//Return:       N/A
+//*****************************************************************************************
+DeltaStepping::DeltaStepping(Graph &g, int bucketWidth, int threadCount)
+	:graph(g),numNodes(0),delta(1),threads(ThreadCount(threadCount)),barrier(threads),cursor(0),bin(0),heavyNext(false),finished(false),
+	 job(0),helpersDone(0),stopping(false),runSrc(0),runState(NULL){
+	g.Freeze();
+	numNodes = g.NumNodes();
+	labels.reset(new atomic<uint64_t>[numNodes]);
+	scanned.reset(new atomic<unsigned char>[numNodes]);
+	for(int v = 0; v < numNodes; v++)
+		scanned[v] = 0;
+	workers.resize(threads);
+	SetDelta(bucketWidth);
+	for(int t = 1; t < threads; t++)
+		helpers.push_back(thread(&DeltaStepping::HelperLoop, this, t));
+}
+
+
+//*****************************************************************************************
+//Function:     Delta Stepping destructor
+//Purpose:      Stop and join the helper threads
+//Incoming:     N/A
+//Outgoing:     N/A
+//Return:       N/A
+//*****************************************************************************************
+DeltaStepping::~DeltaStepping(){
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for(size_t t = 0; t < helpers.size(); t++)
+		helpers[t].join();
+}
+
+
+//*****************************************************************************************
+//Function:     Helper Loop
+//Purpose:      Wait for a run, do this thread's part of it, report back
+//Incoming:     id: which thread (and Worker) this is
+//Outgoing:     N/A
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::HelperLoop(int id){
+	int seen = 0;                              //last run this helper took part in
+	while(true){
+		{
+			unique_lock<mutex> guard(lock);
+			wake.wait(guard, [&]{ return stopping || job != seen; });
+			if(stopping)
+				return;
+			seen = job;
+		}
+
+		Work(id);
+
+		lock_guard<mutex> guard(lock);
+		if(++helpersDone == (int)helpers.size())
+			done.notify_one();
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Set Delta
+//Purpose:      Change the bucket width and redo the light/heavy split. Small buckets do
+//              little wasted work but need many rounds; wide buckets need few rounds but
+//              rescan nodes whose distance is still dropping. The default, the heaviest
+//              weight divided by the average out-degree, is the classic choice for
+//              random weights.
+//Incoming:     bucketWidth: the new delta (0 to pick one from the graph)
+//Outgoing:     delta and the partitioned edge arrays are updated
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::SetDelta(int bucketWidth){
+	if(bucketWidth <= 0){
+		int edges = graph.NumEdges();
+		int heaviest = graph.MaxWeight() == INT_MAX ? 1 : graph.MaxWeight();
+		bucketWidth = edges > 0 ? (int)((long long)heaviest * numNodes / edges) : 1;
+	}
+	delta = max(1, bucketWidth);
+	Partition();
+}
+
+
+//*****************************************************************************************
+//Function:     Partition
+//Purpose:      Copy the graph's adjacency with every row reordered so its light edges
+//              (weight <= delta) come first, and record where the heavy ones start
+//Incoming:     N/A
+//Outgoing:     targets / weights / heavyStart are rebuilt
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::Partition(){
+	const int *offsets = graph.Offsets();
+	const int *adj = graph.Targets();
+	const int *wts = graph.Weights();
+	int edges = offsets[numNodes];
+	targets.resize(edges);
+	weights.resize(edges);
+	heavyStart.resize(numNodes);
+	for(int u = 0; u < numNodes; u++){
+		int light = offsets[u];
+		for(int e = offsets[u]; e < offsets[u+1]; e++){    //light edges from the front
+			if(wts[e] <= delta){
+				targets[light] = adj[e];
+				weights[light] = wts[e];
+				light++;
+			}
+		}
+		heavyStart[u] = light;
+		for(int e = offsets[u]; e < offsets[u+1]; e++){    //then the heavy ones
+			if(wts[e] > delta){
+				targets[light] = adj[e];
+				weights[light] = wts[e];
+				light++;
+			}
+		}
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Relax
+//Purpose:      Offer v the distance "dist" through u. The compare-and-swap loop only
+//              gives up once v's stored distance is no larger, so concurrent offers always
+//              leave the smallest one behind. A successful offer files v in this thread's
+//              bucket for the new distance.
+//Incoming:     me: the calling thread's buffers
+//              u: the node the edge leaves
+//              dist: the distance to v through u
+//              v: the node the edge reaches
+//Outgoing:     labels[v] and me.bins may change
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::Relax(Worker &me, int u, int dist, int v){
+	uint64_t old = labels[v].load(memory_order_relaxed);
+	while(dist < DistOf(old)){
+		if(labels[v].compare_exchange_weak(old, Pack(dist, u), memory_order_relaxed)){
+			size_t b = dist / delta;
+			if(b >= me.bins.size())
+				me.bins.resize(b + 1);
+			me.bins[b].push_back(v);
+			return;
+		}
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Plan Next Bin / Size Frontier
+//Purpose:      Run by one thread between barriers. PlanNextBin moves "bin" to the lowest
+//              bucket any worker still holds (or sets "finished"); SizeFrontier gives each
+//              worker its place in the frontier for the current bucket.
+//Incoming:     N/A
+//Outgoing:     bin / finished, frontier size and each worker's copyAt
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::PlanNextBin(){
+	size_t next = SIZE_MAX;
+	for(int t = 0; t < threads; t++){
+		const vector< vector<int> > &bins = workers[t].bins;
+		for(size_t b = bin + 1; b < bins.size() && b < next; b++){
+			if(!bins[b].empty()){
+				next = b;
+				break;
+			}
+		}
+	}
+	finished = next == SIZE_MAX;
+	if(!finished)
+		bin = (int)next;
+}
+
+void DeltaStepping::SizeFrontier(){
+	size_t total = 0;
+	for(int t = 0; t < threads; t++){
+		workers[t].copyAt = total;
+		if(bin < (int)workers[t].bins.size())
+			total += workers[t].bins[bin].size();
+	}
+	frontier.resize(total);
+	heavyNext = total == 0;
+	cursor = 0;
+}
+
+
+//*****************************************************************************************
+//Function:     Work
+//Purpose:      The body every thread of a run executes. Each bucket goes through light
+//              rounds (relax the light edges of every frontier node, then gather the
+//              nodes that landed back in the bucket as the next frontier) until a round
+//              adds nothing, then one heavy round over every node the bucket settled.
+//              Thread 0 does the bookkeeping between barriers.
+//Incoming:     id: which thread (and Worker) this is; the source and the state to
+//              answer into are runSrc and runState
+//Outgoing:     This thread's share of the answer is written to runState
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::Work(int id){
+	Worker &me = workers[id];
+	int src = runSrc;
+	SearchState &state = *runState;
+	int first = (int)((long long)numNodes * id / threads);      //this thread's slice of the nodes
+	int last = (int)((long long)numNodes * (id + 1) / threads);
+	for(int v = first; v < last; v++)
+		labels[v].store(Pack(INT_MAX, NO_PRED), memory_order_relaxed);
+	for(size_t b = 0; b < me.bins.size(); b++)
+		me.bins[b].clear();
+	me.settled.clear();
+	barrier.Wait();
+	if(id == 0){
+		labels[src].store(Pack(0, NO_PRED));
+		frontier.assign(1, src);
+		bin = 0;
+		cursor = 0;
+		finished = false;
+	}
+	barrier.Wait();
+
+	const int *offsets = graph.Offsets();
+	const size_t chunk = 64;
+	while(true){
+		for(size_t k = cursor.fetch_add(chunk); k < frontier.size(); k = cursor.fetch_add(chunk)){
+			size_t end = min(frontier.size(), k + chunk);
+			for(; k < end; k++){                       //light round
+				int u = frontier[k];
+				int dist = DistOf(labels[u].load(memory_order_relaxed));
+				if(dist / delta != bin)                    //stale entry: u already moved to a lower bucket
+					continue;
+				if(!scanned[u].exchange(1, memory_order_relaxed))
+					me.settled.push_back(u);
+				for(int e = offsets[u]; e < heavyStart[u]; e++)
+					Relax(me, u, dist + weights[e], targets[e]);
+			}
+		}
+		barrier.Wait();
+		if(id == 0)
+			SizeFrontier();
+		barrier.Wait();
+
+		if(heavyNext){                             //the bucket is settled: heavy round
+			for(size_t i = 0; i < me.settled.size(); i++){
+				int u = me.settled[i];
+				int dist = DistOf(labels[u].load(memory_order_relaxed));
+				for(int e = heavyStart[u]; e < offsets[u+1]; e++)
+					Relax(me, u, dist + weights[e], targets[e]);
+				scanned[u].store(0, memory_order_relaxed);
+			}
+			me.settled.clear();
+			barrier.Wait();
+			if(id == 0){
+				PlanNextBin();
+				if(!finished)
+					SizeFrontier();
+			}
+			barrier.Wait();
+			if(finished)
+				break;
+		}
+
+		if(bin < (int)me.bins.size()){             //move this thread's share of the bucket into the frontier
+			vector<int> &mine = me.bins[bin];
+			copy(mine.begin(), mine.end(), frontier.begin() + me.copyAt);
+			mine.clear();
+		}
+		barrier.Wait();
+	}
+
+	for(int v = first; v < last; v++){        //write this thread's slice of the answer
+		uint64_t label = labels[v].load(memory_order_relaxed);
+		if(DistOf(label) != INT_MAX)
+			state.Label(v, DistOf(label), PredOf(label));
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Run
+//Purpose:      Compute distances from src to every node on all threads. Only one Run may
+//              use this object at a time.
+//Incoming:     src: the starting node
+//              state: receives the answer
+//Outgoing:     state.Dist() / state.ChangedBy() hold a full shortest-path tree, exactly as
+//              after Graph::Search(src, NULL, 0, state)
+//Return:       N/A-void function
+//*****************************************************************************************
+void DeltaStepping::Run(int src, SearchState &state){
+	state.Prepare(numNodes);
+	runSrc = src;
+	runState = &state;
+	{
+		lock_guard<mutex> guard(lock);
+		helpersDone = 0;
+		job++;
+	}
+	wake.notify_all();
+	Work(0);                                   //the calling thread is thread 0
+
+	unique_lock<mutex> guard(lock);
+	done.wait(guard, [&]{ return helpersDone == (int)helpers.size(); });
+	runState = NULL;
+}
+
+
+#endif
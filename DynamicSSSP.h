@@ -0,0 +1,294 @@
+#ifndef _DYNAMICSSSP_H
+#define _DYNAMICSSSP_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include "Graph.h"
+#include "PriorityQueue.h"
+using namespace std;
+
+//********************************
+//Dynamic SSSP Class Header
+//********************************
+//A shortest-path tree from one source that is kept correct while edge weights change,
+//in the manner of Ramalingam and Reps. After an edge gets cheaper, only the nodes it
+//actually improves are rescanned, Dijkstra-style, starting at its head. After an edge
+//gets dearer or is removed, the nodes whose distance may grow are found first: a node
+//hanging below the changed tree edge is affected only if it has no other tight in-edge
+//(one on a shortest path) from an unaffected node. The affected nodes then restart from
+//their best unaffected in-neighbour and a Dijkstra over just that set finishes the job.
+//Work is proportional to the part of the tree that changes, not to the graph.
+//
+//Weights must not be negative. The graph is read live, so after changing it directly
+//(Graph::UpdateWeight, Graph::RemoveEdge, or AddAdj followed by Freeze) call EdgeChanged
+//for each edge touched, in order; UpdateWeight and RemoveEdge here do both steps.
+class DynamicSSSP{
+//**************************************************
+//Dynamic SSSP Private Data Members and Functions
+//**************************************************
+	Graph &graph;                              //the graph the tree spans
+	int source;                                //root of the tree
+	vector<int> dist;                          //distance from source (INT_MAX if unreached)
+	vector<int> parent;                        //tree predecessor (INT_MIN for the source and unreached nodes)
+	vector<unsigned> mark;                     //epoch in which a node was found affected
+	unsigned epoch;                            //current value for "mark"
+	vector<int> affected;                      //nodes found affected by the current change
+	PriorityQueue pq;                          //frontier for both phases of a repair
+	int touched;                               //nodes relabelled by the last change
+
+	bool Affected(int i) const { return mark[i] == epoch; }
+	void Grow();                               //size the arrays for nodes added to the graph
+	void Propagate();                          //Dijkstra from whatever is queued
+	void Lower(int from, int to);              //repair after from->to got cheaper
+	void Raise(int to);                        //repair after to's tree edge got dearer
+
+//********************************
+//Dynamic SSSP Public Functions
+//********************************
+public:
+	DynamicSSSP(Graph &g, int src);
+	DynamicSSSP(const DynamicSSSP &) = delete;
+	DynamicSSSP &operator=(const DynamicSSSP &) = delete;
+	int Source() const { return source; }
+	int Dist(int i) const { return dist[i]; }            //distance from the source (INT_MAX if unreachable)
+	int Parent(int i) const { return parent[i]; }        //tree predecessor (INT_MIN if none)
+	int Touched() const { return touched; }              //nodes relabelled by the last change
+	void Rebuild();                            //recompute the whole tree from scratch
+	void EdgeChanged(int from, int to);        //repair after the from->to weight changed in the graph
+	bool UpdateWeight(int from, int to, int wt); //change a weight in the graph and repair
+	bool RemoveEdge(int from, int to);         //remove an edge from the graph and repair
+	bool FindPath(int dest, PathResult &result) const; //read the tree path to dest
+};
+
+
+//*****************************************************************************************
+//Function:     Dynamic SSSP constructor
+//Purpose:      Freeze the graph and grow the full shortest-path tree from src
+//Incoming:     g: the graph to follow; it must outlive this object
+//              src: the root of the tree
+//Outgoing:     Dist / Parent hold the tree for the current weights
+//Return:       N/A
+//*****************************************************************************************
+DynamicSSSP::DynamicSSSP(Graph &g, int src):graph(g),source(src),epoch(0),touched(0){
+	g.Freeze();
+	Rebuild();
+}
+
+
+//*****************************************************************************************
+//Function:     Rebuild
+//Purpose:      Throw the tree away and grow it again with a full Dijkstra search
+//Incoming:     N/A
+//Outgoing:     Dist / Parent hold the tree for the current weights
+//Return:       N/A-void function
+//*****************************************************************************************
+void DynamicSSSP::Rebuild(){
+	graph.Freeze();
+	int nodes = graph.NumNodes();
+	dist.assign(nodes, INT_MAX);
+	parent.assign(nodes, INT_MIN);
+	mark.assign(nodes, 0);
+	epoch = 0;
+	pq.Reserve(nodes);
+	pq.Clear();
+	touched = 0;
+	dist[source] = 0;
+	pq.Enqueue(source, 0);
+	Propagate();
+}
+
+
+//Nodes added since the tree was built start out unreached
+void DynamicSSSP::Grow(){
+	int nodes = graph.NumNodes();
+	if(nodes > (int)dist.size()){
+		dist.resize(nodes, INT_MAX);
+		parent.resize(nodes, INT_MIN);
+		mark.resize(nodes, 0);
+		pq.Reserve(nodes);
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Propagate
+//Purpose:      Run Dijkstra's loop from the nodes already queued, lowering any label an
+//              edge can improve. Queued nodes must carry their current distance.
+//Incoming:     N/A
+//Outgoing:     Every node reachable from the queue has its final distance
+//Return:       N/A-void function
+//*****************************************************************************************
+void DynamicSSSP::Propagate(){
+	const int *offsets = graph.Offsets();
+	const int *targets = graph.Targets();
+	const int *weights = graph.Weights();
+	int eyedist;
+	for(int eye = pq.Dequeue(eyedist); eye != INT_MIN; eye = pq.Dequeue(eyedist)){
+		touched++;
+		for(int e = offsets[eye]; e < offsets[eye+1]; e++){
+			int adj = targets[e];
+			int d = eyedist + weights[e];
+			if(d < dist[adj]){
+				dist[adj] = d;
+				parent[adj] = eye;
+				pq.Enqueue(adj, d);
+			}
+		}
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Edge Changed
+//Purpose:      Bring the tree up to date after the weight of from->to changed in the
+//              graph (including an edge being added or removed). The cheapest remaining
+//              from->to edge decides which way the repair goes.
+//Incoming:     from / to: the endpoints of the changed edge
+//Outgoing:     Dist / Parent hold the tree for the current weights
+//Return:       N/A-void function
+//*****************************************************************************************
+void DynamicSSSP::EdgeChanged(int from, int to){
+	graph.Freeze();
+	Grow();
+	touched = 0;
+	if(from == to || dist[from] == INT_MAX)    //an unreached tail cannot change anything
+		return;
+	int wt = graph.EdgeWeight(from, to);
+	if(wt != INT_MAX && dist[from] + wt < dist[to])
+		Lower(from, to);
+	else if(parent[to] == from && (wt == INT_MAX || dist[from] + wt > dist[to]))
+		Raise(to);
+}
+
+
+//Repair after from->to got cheaper: only nodes the edge improves are rescanned
+void DynamicSSSP::Lower(int from, int to){
+	dist[to] = dist[from] + graph.EdgeWeight(from, to);
+	parent[to] = from;
+	pq.Enqueue(to, dist[to]);
+	Propagate();
+}
+
+
+//*****************************************************************************************
+//Function:     Raise
+//Purpose:      Repair after the tree edge into "to" got dearer or went away. Candidates
+//              are taken from the subtree below "to" in order of their old distance, so
+//              when one is examined every node closer to the source already has its
+//              status. A candidate with a tight in-edge from an unaffected node keeps its
+//              distance and just switches parent; otherwise it is affected and its tree
+//              children become candidates. Zero-weight in-edges are not trusted as
+//              alternatives, since their tail may still be undecided; that only makes
+//              the affected set larger, never wrong.
+//Incoming:     to: the head of the changed tree edge
+//Outgoing:     Dist / Parent hold the tree for the current weights
+//Return:       N/A-void function
+//*****************************************************************************************
+void DynamicSSSP::Raise(int to){
+	const int *offsets = graph.Offsets();
+	const int *targets = graph.Targets();
+	const int *revOffsets = graph.ReverseOffsets();
+	const int *revSources = graph.ReverseSources();
+	const int *revWeights = graph.ReverseWeights();
+
+	if(++epoch == 0){                          //the counter wrapped: old marks could look current
+		fill(mark.begin(), mark.end(), 0);
+		epoch = 1;
+	}
+	affected.clear();
+
+	//Phase 1: find the nodes whose distance must grow
+	pq.Enqueue(to, dist[to]);
+	int old;
+	for(int y = pq.Dequeue(old); y != INT_MIN; y = pq.Dequeue(old)){
+		int keep = INT_MIN;                        //an unaffected tight in-neighbour, if any
+		for(int e = revOffsets[y]; e < revOffsets[y+1]; e++){
+			int z = revSources[e];
+			if(revWeights[e] > 0 && !Affected(z) && dist[z] != INT_MAX && dist[z] + revWeights[e] == old){
+				keep = z;
+				break;
+			}
+		}
+		if(keep != INT_MIN){
+			parent[y] = keep;
+			continue;
+		}
+		mark[y] = epoch;
+		affected.push_back(y);
+		for(int e = offsets[y]; e < offsets[y+1]; e++){ //its tree children become candidates
+			int child = targets[e];
+			if(parent[child] == y && !Affected(child))
+				pq.Enqueue(child, dist[child]);
+		}
+	}
+
+	//Phase 2: restart each affected node from its best unaffected in-neighbour
+	for(size_t i = 0; i < affected.size(); i++){
+		dist[affected[i]] = INT_MAX;
+		parent[affected[i]] = INT_MIN;
+	}
+	for(size_t i = 0; i < affected.size(); i++){
+		int y = affected[i];
+		for(int e = revOffsets[y]; e < revOffsets[y+1]; e++){
+			int z = revSources[e];
+			if(Affected(z) || dist[z] == INT_MAX)
+				continue;
+			int d = dist[z] + revWeights[e];
+			if(d < dist[y]){
+				dist[y] = d;
+				parent[y] = z;
+			}
+		}
+		if(dist[y] != INT_MAX)
+			pq.Enqueue(y, dist[y]);
+	}
+	Propagate();                               //and settle the affected set among itself
+}
+
+
+//*****************************************************************************************
+//Function:     Update Weight / Remove Edge
+//Purpose:      Change the graph and repair the tree in one call. Other trees on the
+//              same graph still need their own EdgeChanged.
+//Incoming:     from / to: the endpoints of the edge
+//              wt: its new weight (UpdateWeight only)
+//Outgoing:     The graph and the tree are both updated
+//Return:       Whether the graph had a from->to edge
+//*****************************************************************************************
+bool DynamicSSSP::UpdateWeight(int from, int to, int wt){
+	if(!graph.UpdateWeight(from, to, wt))
+		return false;
+	EdgeChanged(from, to);
+	return true;
+}
+
+bool DynamicSSSP::RemoveEdge(int from, int to){
+	if(!graph.RemoveEdge(from, to))
+		return false;
+	EdgeChanged(from, to);
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path
+//Purpose:      Read the tree path from the source to dest
+//Incoming:     dest: the destination node
+//              result: receives the cost and the path
+//Outgoing:     result is filled in
+//Return:       Whether dest is reachable
+//*****************************************************************************************
+bool DynamicSSSP::FindPath(int dest, PathResult &result) const{
+	result.cost = dist[dest];
+	result.path.clear();
+	if(result.cost == INT_MAX)
+		return false;
+	for(int location = dest; location != INT_MIN; location = parent[location])
+		result.path.push_back(location);
+	reverse(result.path.begin(), result.path.end());
+	return true;
+}
+
+
+#endif
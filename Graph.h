@@ -3,49 +3,216 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <memory>
 #include "PriorityQueue.h"
+#include "BucketQueue.h"
+#include "Arena.h"
+#include "SearchStats.h"
 using namespace std;
 
-const int SIZE = 7;
+//********************************
+//Search State Struct
+//********************************
+//Scratch arrays for one search. A worker keeps one of these and reuses it for every
+//query it runs, so searching never allocates once the arrays have reached graph size.
+//Each node's entries only count if its stamp matches the current generation, so a new
+//search starts by bumping the generation instead of clearing every node. Read results
+//through Dist() and ChangedBy(), not the raw arrays.
+struct SearchState{
+	vector<int> distFromSrc;                   //distance from source parallel array
+	vector<int> changedby;                     //who changed me parallel array
+	vector<unsigned> stamp;                    //generation that last wrote each node
+	unsigned generation;                       //generation of the current search
+	vector<char> wanted;                       //is this node a destination we still need?
+	PriorityQueue pq;                          //frontier of the search
+	BucketQueue buckets;                       //frontier instead of pq when the graph's weights are small
+	SearchStats stats;                         //work done by the last search (only counted with -DSEARCH_STATS)
+	bool heapOnly;                             //search on pq even where buckets would be used (to compare them)
+	
+	SearchState():generation(0),heapOnly(false){};
+	void Prepare(int nodes);                   //size for the graph and start a new search
+	bool Reached(int i) const { return stamp[i] == generation; }                      //has this search reached node i?
+	int Dist(int i) const { return Reached(i) ? distFromSrc[i] : INT_MAX; }          //distance from source (INT_MAX if unreached)
+	int ChangedBy(int i) const { return Reached(i) ? changedby[i] : INT_MIN; }       //predecessor (INT_MIN if none)
+	void Label(int i, int dist, int by){ stamp[i] = generation; distFromSrc[i] = dist; changedby[i] = by; } //record a new distance
+};
+
+
+//*****************************************************************************************
+//Function:     Prepare
+//Purpose:      Size the search arrays for a graph and start a new search. Only the
+//              first call for a given graph size touches every node; after that a new
+//              search is O(1) plus the cost of emptying the last search's queue.
+//Incoming:     nodes: the number of nodes in the graph being searched
+//Outgoing:     Every node is unreached again and the queue is empty
+//Return:       N/A-void function
+//*****************************************************************************************
+void SearchState::Prepare(int nodes){
+	if((int)stamp.size() != nodes){            //first search on a graph of this size
+		distFromSrc.resize(nodes);
+		changedby.resize(nodes);
+		stamp.assign(nodes, 0);
+		wanted.assign(nodes, 0);
+		generation = 0;
+		pq.Reserve(nodes);
+		buckets.Reserve(nodes);
+	}
+	if(++generation == 0){                     //the counter wrapped: old stamps could look current
+		fill(stamp.begin(), stamp.end(), 0);
+		generation = 1;
+	}
+	pq.Clear();
+	buckets.Clear();
+}
+
+
+//********************************
+//Path Result Struct
+//********************************
+//The answer to one query: its total cost and the nodes visited from src to dest.
+//Reusing a PathResult across queries reuses the memory of its path vector.
+struct PathResult{
+	int cost;                                  //total travel cost (INT_MAX if unreachable)
+	vector<int> path;                          //node indices from src to dest (empty if unreachable)
+	
+	PathResult():cost(INT_MAX){};
+	bool Found() const { return cost != INT_MAX; }
+};
+
+
+//Heaviest edge weight for which searches use a BucketQueue instead of the heap. Dial's
+//algorithm walks one bucket per unit of distance, so it only pays off while edges are
+//short compared to how many nodes share each distance.
+const int BUCKET_QUEUE_MAX_WEIGHT = 1024;
+
+
+//Which algorithm ShortestPath uses
+enum SearchMode{
+	DIJKSTRA,                                  //one frontier grown from src
+	BIDIRECTIONAL                              //frontiers grown from src and dest until they meet
+};
+
 
 //********************************
 //Graph Class Header
 //********************************
 class Graph{
     //********************************
-    //GNode Struct Implementation
+    //Edge Struct Implementation
     //********************************
-	struct GNode{
-    	int wt;            //Weight
-    	int adj;           //Adjacency
-    	GNode* next;       //Pointer to next GNode (or NULL)
-    	
-    	GNode():wt(-1),adj(-1),next(NULL){};
-    	GNode(int weight, int adjacency):wt(weight),adj(adjacency),next(NULL){};
+	struct Edge{
+		int from;          //Source node
+		int wt;            //Weight
+		int adj;           //Adjacency
+
+		Edge():from(-1),wt(-1),adj(-1){};
+		Edge(int source, int weight, int adjacency):from(source),wt(weight),adj(adjacency){};
 	};
+	typedef vector< Edge, ArenaAllocator<Edge> > EdgeBuffer;
 	
 //******************************************
 //Graph Private Data Members and Functions
 //******************************************
-	GNode* adjList[SIZE];                      //adjacency list parallel array
-	string names[SIZE];                        //names parallel array
-	int distFromSrc[SIZE];                     //distance from source parallel array
-	int changedby[SIZE];                       //who changed me parallel array
+	int numNodes;                              //number of nodes (stops) in the graph
+	Arena build;                               //memory for pending edges and Freeze's scratch arrays
+	EdgeBuffer pending;                        //edges added since the last Freeze(), not yet searchable
+	vector<int> offsets;                       //CSR row offsets: node i's adjacencies are [offsets[i], offsets[i+1])
+	vector<int> targets;                       //CSR adjacency (destination node) of each edge
+	vector<int> weights;                       //CSR weight of each edge, parallel to targets
+	vector<int> revOffsets;                    //reverse CSR row offsets: edges arriving at node i
+	vector<int> revSources;                    //reverse CSR: the node each arriving edge leaves from
+	vector<int> revWeights;                    //reverse CSR weight, parallel to revSources
+	vector<char> nameChars;                    //every node name stored back to back
+	vector<int> nameOffsets;                   //node i's name is nameChars[nameOffsets[i], nameOffsets[i+1])
+	
+	const int *rowOffsets;                     //read-only views of the arrays above, or of a
+	const int *adjTargets;                     //mapped snapshot when "backing" is set; every
+	const int *adjWeights;                     //search reads the graph through these
+	const int *revRowOffsets;
+	const int *revAdjSources;
+	const int *revAdjWeights;
+	const int *nameIndex;
+	const char *nameText;
+	int frozenEdges;                           //number of edges in the CSR views
+	int removedEdges;                          //edges RemoveEdge has emptied since the last Freeze()
+	vector<char> removed;                      //marks the emptied edges, parallel to targets (empty if none)
+	vector<char> revRemoved;                   //the same marks, parallel to revSources
+	int maxWeight;                             //heaviest frozen edge weight (INT_MAX if any weight is negative)
+	unsigned long long version;                //bumped by every change that can alter a shortest path or the node count
+	shared_ptr<const void> backing;            //keeps external (mapped) storage alive
 	
-	void PrintPath(int src, int dest);
-	void PrintPathHelper(int location, int src, int dest);
+	SearchState search;                        //scratch state used by ShortestPath
+	SearchState searchBack;                    //backward scratch state for bidirectional searches
+	PathResult answer;                         //result buffer reused by every ShortestPath call
+	SearchStats lastStats;                     //stats of the last ShortestPath call
 	
-	void Reset();                              //reset the graph for another algorithm to run
+	void SyncViews();                          //point the views at the owned arrays
+	void Detach();                             //copy external storage into the owned arrays
+	void BuildReverse();                       //rebuild the reverse CSR from the forward one
+	void ReleasePending();                     //empty pending and hand the build arena back
+	int SetWeight(int from, int to, int wt, bool remove); //rewrite every frozen from->to edge
+	
+	template<class Queue>
+	void SearchWith(int src, const int *dests, int count, SearchState &state, bool reverse, Queue &pq) const;
+	template<class Queue>
+	int SearchBidirectionalWith(int src, int dest, SearchState &fwd, SearchState &bwd, Queue &fq, Queue &bq, int &cost) const;
+	template<class Heuristic, class Queue>
+	void SearchAStarWith(int src, int dest, Heuristic &h, SearchState &state, Queue &pq) const;
 	
 //******************************************
 //Graph Public Functions
 //******************************************
 public:
 	Graph();                                   //Default Constructor
-	~Graph();								   //Destructor
+	explicit Graph(int nodes);                 //Graph with "nodes" unnamed nodes
+	Graph(const Graph &) = delete;             //graphs are shared by reference, never copied
+	Graph &operator=(const Graph &) = delete;
+	void Reserve(int nodes, int edges);        //Pre-size storage for a graph of known size
+	void Resize(int nodes);                    //Grow the graph to at least "nodes" nodes
+	int AddNode(const string &name);           //Append a named node, returns its index
+	int AddNode(const char *name, int length); //Append a named node from raw characters
 	void AddAdj(int index, int wt, int adj);   //Add adjacency
-	string GetName(int i){ return names[i]; }  //Get name of given index
-	void ShortestPath(int src, int dest);      //Find a shortest path from src to dest
+	void Freeze();                             //Pack pending adjacencies into the CSR arrays
+	bool UpdateWeight(int from, int to, int wt); //Change the weight of the from->to adjacency
+	bool RemoveEdge(int from, int to);         //Take the from->to adjacency out of the graph
+	int EdgeWeight(int from, int to) const;    //Cheapest frozen from->to weight (INT_MAX if none)
+	int NumNodes() const { return numNodes; }  //Number of nodes
+	int NumEdges() const { return frozenEdges + (int)pending.size() - removedEdges; } //Number of adjacencies
+	int MaxWeight() const { return maxWeight; } //Heaviest frozen edge weight (INT_MAX if any is negative)
+	unsigned long long Version() const { return version; } //Changes whenever nodes or edges are added or edges reweighted
+	bool UsesBuckets() const { return maxWeight <= BUCKET_QUEUE_MAX_WEIGHT; } //do searches run Dial's algorithm?
+	string GetName(int i) const;               //Get name of given index
+	void PrintName(int i, ostream &out) const; //Print the name of a node without copying it
+	
+	const int *Offsets() const { return rowOffsets; }       //CSR row offsets (NumNodes()+1 entries)
+	const int *Targets() const { return adjTargets; }       //CSR adjacency of each frozen edge
+	const int *Weights() const { return adjWeights; }       //CSR weight of each frozen edge
+	const int *ReverseOffsets() const { return revRowOffsets; } //reverse CSR row offsets (NumNodes()+1 entries)
+	const int *ReverseSources() const { return revAdjSources; } //reverse CSR: source of each arriving edge
+	const int *ReverseWeights() const { return revAdjWeights; } //reverse CSR weight of each arriving edge
+	const int *NameOffsets() const { return nameIndex; }    //name offsets (NumNodes()+1 entries)
+	const char *NameChars() const { return nameText; }      //all names back to back
+	void Attach(int nodes, int edges, int maxWt, const int *offs, const int *tgts, const int *wts,
+	            const int *revOffs, const int *revSrcs, const int *revWts,
+	            const int *nameOffs, const char *names, shared_ptr<const void> owner); //use external storage
+	void ShortestPath(int src, int dest, SearchMode mode = DIJKSTRA); //Find a shortest path from src to dest and print it
+	bool FindPath(int src, int dest, PathResult &result); //Find a shortest path from src to dest
+	bool FindPath(int src, int dest, SearchState &state, PathResult &result) const; //same, in a caller's state
+	void BuildPath(int src, int dest, const SearchState &state, PathResult &result) const; //read a path out of a finished search
+	void PrintPath(const PathResult &result, ostream &out) const; //Print a path for the user
+	void Report(int src, int dest, const PathResult &result, ostream &out) const; //Print a whole answer for the user
+	const SearchStats &LastStats() const { return lastStats; } //work done by the last ShortestPath call
+	
+	template<class Heuristic>
+	bool FindPathAStar(int src, int dest, Heuristic &h, SearchState &state, PathResult &result) const; //Find a shortest path guided by h
+	template<class Heuristic>
+	void SearchAStar(int src, int dest, Heuristic &h, SearchState &state) const; //A* from src towards dest into state
+	
+	bool FindPathBidirectional(int src, int dest, PathResult &result); //Find a shortest path searching from both ends
+	bool FindPathBidirectional(int src, int dest, SearchState &fwd, SearchState &bwd, PathResult &result) const;
+	int SearchBidirectional(int src, int dest, SearchState &fwd, SearchState &bwd, int &cost) const; //returns the meeting node
+	void Search(int src, const int *dests, int count, SearchState &state, bool reverse = false) const; //Dijkstra from src into state
 };
 
 
@@ -57,46 +224,203 @@ public:
 //Return:       N/A
 //Authors:      Tay Cavett, Joshua Brown
 //*****************************************************************************************
-Graph::Graph(){
-	for(int i = 0; i < SIZE; i++){  //loop through entire adjacency list
-		adjList[i] = NULL;              //set all pointers to NULL
-		distFromSrc[i] = INT_MAX;
-		changedby[i] = INT_MIN;
-	}
-	                                //hardcoded all the names for our particular graph
-	names[0] = "Empire State Building";		//0
-	names[1] = "Penn Station";				//1
-	names[2] = "Rector Street Station";		//2
-	names[3] = "9/11 Memorial";				//3
-	names[4] = "Wall Street Station";		//4
-	names[5] = "Grand Army Plaza Station";	//5
-	names[6] = "Grand Army Plaza";			//6
+Graph::Graph():numNodes(0),pending(ArenaAllocator<Edge>(&build)),frozenEdges(0),removedEdges(0),maxWeight(0),version(0){
+	offsets.assign(1, 0);           //the empty graph has a single CSR sentinel offset
+	revOffsets.assign(1, 0);
+	nameOffsets.assign(1, 0);
+	SyncViews();
 }
 
-void Graph::Reset(){
-	for(int i = 0; i < SIZE; i++){  //loop through entire adjacency list
-		distFromSrc[i] = INT_MAX;
-		changedby[i] = INT_MIN;
-	}
+
+//*****************************************************************************************
+//Function:     Graph sized constructor
+//Purpose:      To create a graph with a known number of unnamed nodes and no edges
+//Incoming:     nodes: how many nodes the graph starts with
+//Outgoing:     A new graph
+//Return:       N/A
+//*****************************************************************************************
+Graph::Graph(int nodes):numNodes(0),pending(ArenaAllocator<Edge>(&build)),frozenEdges(0),removedEdges(0),maxWeight(0),version(0){
+	offsets.assign(1, 0);
+	revOffsets.assign(1, 0);
+	nameOffsets.assign(1, 0);
+	SyncViews();
+	Resize(nodes);
 }
 
 
 //*****************************************************************************************
-//Function:     Graph destructor
-//Purpose:      To destroy the graph
-//Incoming:     N/A
+//Function:     Reserve
+//Purpose:      Pre-size the graph's storage from a known node and edge count, so that a
+//              bulk load never reallocates
+//Incoming:     nodes: expected number of nodes
+//              edges: expected number of adjacencies
+//Outgoing:     Storage capacity grown to fit
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::Reserve(int nodes, int edges){
+	nameOffsets.reserve((size_t)nodes + 1);
+	offsets.reserve((size_t)nodes + 1);
+	revOffsets.reserve((size_t)nodes + 1);
+	pending.reserve(edges);
+}
+
+
+//*****************************************************************************************
+//Function:     Resize
+//Purpose:      Grow the graph to at least "nodes" nodes. New nodes are unnamed and have
+//              no adjacencies; the graph never shrinks.
+//Incoming:     nodes: the new minimum node count
+//Outgoing:     numNodes and the per-node arrays are updated, and the version moves on
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::Resize(int nodes){
+	if(nodes <= numNodes)
+		return;
+	Detach();
+	nameOffsets.resize(nodes + 1, (int)nameChars.size());   //unnamed nodes have empty names
+	offsets.resize(nodes + 1, offsets.back());              //and empty CSR rows
+	revOffsets.resize(nodes + 1, revOffsets.back());
+	numNodes = nodes;
+	version++;                                 //per-node caches sized for the old count are stale
+	SyncViews();
+}
+
+
+//*****************************************************************************************
+//Function:     Add Node
+//Purpose:      Append a new node with the given name
+//Incoming:     name / length: the node's name
+//Outgoing:     The graph has one more node, and the version moves on
+//Return:       The index of the new node
+//*****************************************************************************************
+int Graph::AddNode(const string &name){
+	return AddNode(name.data(), (int)name.size());
+}
+
+int Graph::AddNode(const char *name, int length){
+	Detach();
+	nameChars.insert(nameChars.end(), name, name + length);
+	nameOffsets.push_back((int)nameChars.size());
+	offsets.push_back(offsets.back());
+	revOffsets.push_back(revOffsets.back());
+	version++;                                 //per-node caches sized for the old count are stale
+	SyncViews();
+	return numNodes++;
+}
+
+
+//*****************************************************************************************
+//Function:     Get Name / Print Name
+//Purpose:      Look up the name of a node; unnamed nodes are reported by their index.
+//              PrintName writes it straight from the name storage, without a string.
+//Incoming:     i: index of the node
+//              out: the stream to print to (PrintName only)
 //Outgoing:     N/A
-//Return:       N/A
-//Authors:      Tay Cavett, Joshua Brown
+//Return:       The node's name (GetName only)
 //*****************************************************************************************
-Graph::~Graph(){
-	for(int i=0; i<SIZE; i++){         //loop through every node
-		while(adjList[i]){                 //loop through all its adjacencies
-			GNode* temp = adjList[i];          //temp var
-			adjList[i] = temp->next;           //move to next adjacency (or NULL)
-			delete temp;                       //delete the old previus adjacency (what temp points to)
-		}
-	}
+string Graph::GetName(int i) const{
+	if(nameIndex[i] == nameIndex[i+1])
+		return "#" + to_string(i);
+	return string(nameText + nameIndex[i], nameIndex[i+1] - nameIndex[i]);
+}
+
+void Graph::PrintName(int i, ostream &out) const{
+	if(nameIndex[i] == nameIndex[i+1])
+		out << "#" << i;
+	else
+		out.write(nameText + nameIndex[i], nameIndex[i+1] - nameIndex[i]);
+}
+
+
+//*****************************************************************************************
+//Function:     Sync Views
+//Purpose:      Point the read-only views at the graph's own arrays. Called after every
+//              change to those arrays, since a vector may move when it grows.
+//Incoming:     N/A
+//Outgoing:     Views refer to the owned arrays
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::SyncViews(){
+	rowOffsets = offsets.data();
+	adjTargets = targets.data();
+	adjWeights = weights.data();
+	revRowOffsets = revOffsets.data();
+	revAdjSources = revSources.data();
+	revAdjWeights = revWeights.data();
+	nameIndex = nameOffsets.data();
+	nameText = nameChars.data();
+	frozenEdges = (int)targets.size();
+}
+
+
+//*****************************************************************************************
+//Function:     Detach
+//Purpose:      If the graph is reading external storage (a mapped snapshot), copy it into
+//              the graph's own arrays so it can be changed. Otherwise do nothing.
+//Incoming:     N/A
+//Outgoing:     The graph owns its storage
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::Detach(){
+	if(!backing)
+		return;
+	offsets.assign(rowOffsets, rowOffsets + numNodes + 1);
+	targets.assign(adjTargets, adjTargets + frozenEdges);
+	weights.assign(adjWeights, adjWeights + frozenEdges);
+	revOffsets.assign(revRowOffsets, revRowOffsets + numNodes + 1);
+	revSources.assign(revAdjSources, revAdjSources + frozenEdges);
+	revWeights.assign(revAdjWeights, revAdjWeights + frozenEdges);
+	nameOffsets.assign(nameIndex, nameIndex + numNodes + 1);
+	nameChars.assign(nameText, nameText + nameIndex[numNodes]);
+	backing.reset();
+	SyncViews();
+}
+
+
+//*****************************************************************************************
+//Function:     Attach
+//Purpose:      Replace the graph's contents with CSR and name arrays that live elsewhere
+//              (for example a memory-mapped snapshot). Nothing is copied; the graph keeps
+//              "owner" alive for as long as it reads from the arrays, and copies them only
+//              if it is changed later.
+//Incoming:     nodes / edges: sizes of the arrays
+//              maxWt: the heaviest weight in wts (INT_MAX if any is negative)
+//              offs, tgts, wts: CSR offsets (nodes+1), targets and weights (edges)
+//              revOffs, revSrcs, revWts: the same for the reverse CSR
+//              nameOffs, names: name offsets (nodes+1) and name characters
+//              owner: whatever keeps the arrays valid
+//Outgoing:     The graph reads from the external arrays
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::Attach(int nodes, int edges, int maxWt, const int *offs, const int *tgts, const int *wts,
+                   const int *revOffs, const int *revSrcs, const int *revWts,
+                   const int *nameOffs, const char *names, shared_ptr<const void> owner){
+	ReleasePending();
+	vector<int>().swap(offsets);
+	vector<int>().swap(targets);
+	vector<int>().swap(weights);
+	vector<int>().swap(revOffsets);
+	vector<int>().swap(revSources);
+	vector<int>().swap(revWeights);
+	vector<int>().swap(nameOffsets);
+	vector<char>().swap(nameChars);
+	
+	numNodes = nodes;
+	frozenEdges = edges;
+	removedEdges = 0;
+	vector<char>().swap(removed);
+	vector<char>().swap(revRemoved);
+	maxWeight = maxWt;
+	version++;
+	rowOffsets = offs;
+	adjTargets = tgts;
+	adjWeights = wts;
+	revRowOffsets = revOffs;
+	revAdjSources = revSrcs;
+	revAdjWeights = revWts;
+	nameIndex = nameOffs;
+	nameText = names;
+	backing = owner;
 }
 
 
@@ -111,92 +435,619 @@ Graph::~Graph(){
 //Authors:	    Tay Cavett, Joshua Brown
 //*****************************************************************************************
 void Graph::AddAdj(int index, int wt, int adj){
-	if(adjList[index] == NULL){                //if there is no adjacency for the current node,
-		adjList[index] = new GNode(wt, adj);      //then add the new one to that node
-	} else {                                   //if there is already at least one adjacency,
-		GNode* temp = adjList[index];             //use a temp variable
-		while(temp->next != NULL){                //to loop to the end of the adjacency "chain"
-			temp = temp->next;
+	Resize(max(index, adj) + 1);               //make sure both endpoints exist
+	pending.push_back(Edge(index, wt, adj));   //queue the adjacency; Freeze() moves it into the CSR arrays
+	version++;
+}
+
+
+//*****************************************************************************************
+//Function:     Freeze
+//Purpose:      Rebuild the compressed sparse row arrays from the current rows plus every
+//              adjacency added since the last call, in one counting pass. Each node keeps
+//              its adjacencies in insertion order, exactly as the old linked lists did.
+//              Edges emptied by RemoveEdge are dropped on the way.
+//Incoming:     N/A
+//Outgoing:     offsets/targets/weights hold every edge, the reverse CSR is rebuilt,
+//              maxWeight is updated, pending is emptied, and the version moves on
+//              if any edge was packed
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::Freeze(){
+	if(pending.empty() && removedEdges == 0)   //nothing new to pack
+		return;
+	Detach();
+
+	int nodes = numNodes;
+	bool compact = !removed.empty();
+	vector<int> newOffsets(nodes + 1, 0);
+	for(int i = 0; i < nodes; i++){            //count the edges already in each row
+		newOffsets[i+1] = offsets[i+1] - offsets[i];
+		for(int e = offsets[i]; compact && e < offsets[i+1]; e++)
+			newOffsets[i+1] -= removed[e];
+	}
+	for(size_t e = 0; e < pending.size(); e++) //plus the new ones
+		newOffsets[pending[e].from + 1]++;
+	for(int i = 0; i < nodes; i++)             //prefix sum turns the counts into row offsets
+		newOffsets[i+1] += newOffsets[i];
+
+	int edges = newOffsets[nodes];
+	vector<int> newTargets(edges), newWeights(edges);
+	vector< int, ArenaAllocator<int> > fill(newOffsets.begin(), newOffsets.end() - 1, ArenaAllocator<int>(&build)); //next free slot in each row
+	for(int i = 0; i < nodes; i++){            //copy the existing rows first
+		for(int e = offsets[i]; e < offsets[i+1]; e++){
+			if(compact && removed[e])
+				continue;
+			newTargets[fill[i]] = targets[e];
+			newWeights[fill[i]] = weights[e];
+			fill[i]++;
+		}
+	}
+	for(size_t e = 0; e < pending.size(); e++){//then append the pending edges to the end of their rows
+		int slot = fill[pending[e].from]++;
+		newTargets[slot] = pending[e].adj;
+		newWeights[slot] = pending[e].wt;
+		if(pending[e].wt > maxWeight || pending[e].wt < 0)
+			maxWeight = pending[e].wt < 0 ? INT_MAX : pending[e].wt;   //a negative weight rules the buckets out for good
+	}
+
+	offsets.swap(newOffsets);
+	targets.swap(newTargets);
+	weights.swap(newWeights);
+	removedEdges = 0;
+	vector<char>().swap(removed);
+	vector<char>().swap(revRemoved);
+	if(!pending.empty())                       //the new edges only become searchable now, so
+		version++;                             //anything found before this must not outlive it
+	BuildReverse();
+	SyncViews();
+	ReleasePending();                          //release the staging buffers in one go
+}
+
+
+//*****************************************************************************************
+//Function:     Release Pending
+//Purpose:      Forget the pending edges and free the build arena. Everything allocated
+//              from the arena (pending itself and Freeze's scratch arrays) goes at once.
+//Incoming:     N/A
+//Outgoing:     pending is empty and the arena holds no memory
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::ReleasePending(){
+	EdgeBuffer(ArenaAllocator<Edge>(&build)).swap(pending);
+	build.Reset();
+}
+
+
+//*****************************************************************************************
+//Function:     Update Weight / Remove Edge
+//Purpose:      Change a live graph in place. Pending adjacencies are frozen first, then
+//              every from->to edge is rewritten in both the forward and reverse CSR, so
+//              the row layout (and every search array sized for it) stays as it is.
+//              A removed edge is marked in "removed" and turned into a zero-weight
+//              self-loop on "from", which no search can ever relax, and is dropped for
+//              good by the next Freeze. Searches must not run on the graph while it is
+//              being changed.
+//Incoming:     from / to: the endpoints of the adjacency
+//              wt: its new weight (UpdateWeight only)
+//Outgoing:     The edge is reweighted or gone; maxWeight still bounds every weight
+//              and the graph's version moves on
+//Return:       Whether the graph had a from->to edge
+//*****************************************************************************************
+bool Graph::UpdateWeight(int from, int to, int wt){
+	if(SetWeight(from, to, wt, false) == 0)
+		return false;
+	version++;
+	if(wt > maxWeight || wt < 0)
+		maxWeight = wt < 0 ? INT_MAX : wt;     //a heavier edge may take the graph off the buckets
+	return true;
+}
+
+bool Graph::RemoveEdge(int from, int to){
+	int count = SetWeight(from, to, 0, true);
+	removedEdges += count;
+	version += count > 0;
+	return count > 0;
+}
+
+
+//Rewrite the live from->to edges in both CSRs, returning how many there were
+int Graph::SetWeight(int from, int to, int wt, bool remove){
+	if(from < 0 || to < 0 || from >= numNodes || to >= numNodes)
+		return 0;
+	Freeze();
+	Detach();
+	if(remove && removed.empty()){
+		removed.assign(targets.size(), 0);
+		revRemoved.assign(revSources.size(), 0);
+	}
+	int found = 0;
+	for(int e = offsets[from]; e < offsets[from+1]; e++){
+		if(targets[e] != to || (!removed.empty() && removed[e]))
+			continue;
+		weights[e] = wt;
+		if(remove){
+			targets[e] = from;
+			removed[e] = 1;
+		}
+		found++;
+	}
+	for(int e = revOffsets[to]; found > 0 && e < revOffsets[to+1]; e++){
+		if(revSources[e] != from || (!revRemoved.empty() && revRemoved[e]))
+			continue;
+		revWeights[e] = wt;
+		if(remove){
+			revSources[e] = to;
+			revRemoved[e] = 1;
 		}
-		temp->next = new GNode(wt, adj);          //add the new adjacency to the end of the "chain"
 	}
+	return found;
 }
 
 
 //*****************************************************************************************
-//Function:     Shortest Path
-//Purpose:      Find a shortest path from src to dest, using Dijkstra's algorithm.
-//              Then print this path for the user.
+//Function:     Edge Weight
+//Purpose:      Look up the cheapest frozen edge from "from" to "to", skipping edges
+//              RemoveEdge has taken out
+//Incoming:     from / to: the endpoints
+//Outgoing:     N/A
+//Return:       The weight, or INT_MAX if there is no such edge
+//*****************************************************************************************
+int Graph::EdgeWeight(int from, int to) const{
+	int best = INT_MAX;
+	for(int e = rowOffsets[from]; e < rowOffsets[from+1]; e++){
+		if(adjTargets[e] == to && adjWeights[e] < best && (removed.empty() || !removed[e]))
+			best = adjWeights[e];
+	}
+	return best;
+}
+
+
+//*****************************************************************************************
+//Function:     Build Reverse
+//Purpose:      Rebuild the reverse CSR (every edge filed under the node it arrives at)
+//              from the forward CSR with one counting pass
+//Incoming:     N/A
+//Outgoing:     revOffsets/revSources/revWeights mirror offsets/targets/weights
+//Return:       N/A-void function
+//*****************************************************************************************
+void Graph::BuildReverse(){
+	int nodes = numNodes;
+	int edges = (int)targets.size();
+	revOffsets.assign(nodes + 1, 0);
+	for(int e = 0; e < edges; e++)             //count the edges arriving at each node
+		revOffsets[targets[e] + 1]++;
+	for(int i = 0; i < nodes; i++)
+		revOffsets[i+1] += revOffsets[i];
+
+	revSources.resize(edges);
+	revWeights.resize(edges);
+	vector< int, ArenaAllocator<int> > fill(revOffsets.begin(), revOffsets.end() - 1, ArenaAllocator<int>(&build));
+	for(int i = 0; i < nodes; i++){
+		for(int e = offsets[i]; e < offsets[i+1]; e++){
+			int slot = fill[targets[e]]++;
+			revSources[slot] = i;
+			revWeights[slot] = weights[e];
+		}
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Search
+//Purpose:      Run Dijkstra's algorithm from src, leaving the distances and "changedby"
+//              links in the given state. The search stops as soon as every destination
+//              has been settled, or runs over the whole graph if there are none. It only
+//              reads the graph, so several threads may search at once with their own
+//              states once the graph is frozen. Graphs whose edges are all short
+//              (see BUCKET_QUEUE_MAX_WEIGHT) run on the state's bucket queue, everything
+//              else on its heap (always the heap if state.heapOnly is set); both give
+//              the same distances. Built with -DSEARCH_STATS, the work done is counted
+//              into state.stats.
 //Incoming:     src: the index of the starting node
-//              dest: the index of the destination node
-//Outgoing:	    Printing the path to the screen
+//              dests / count: the destinations to settle (count 0 for all nodes)
+//              state: the scratch state to search in
+//              reverse: follow edges backwards, giving distances *to* src instead
+//Outgoing:	    state.Dist() / state.ChangedBy() are final for every settled node
 //Return:	    N/A-void function
 //Authors:	    Joshua Brown, Tay Cavett, Jalyn Cosby, Whittney Schwarz
 //*****************************************************************************************
-void Graph::ShortestPath(int src, int dest){
-	int eye = src;                 //"eyeball" index
-	int eyedist = 0;               //distance the eye is from the src
-	distFromSrc[src] = eyedist;    //update this distance in the distFromSrc parallel array
+void Graph::Search(int src, const int *dests, int count, SearchState &state, bool reverse) const{
+	auto run = [&](auto &queue){ SearchWith(src, dests, count, state, reverse, queue); };
+	if(UsesBuckets() && !state.heapOnly){
+		state.buckets.SetSpan(maxWeight);
+		Instrumented(state.buckets, state.stats, run);
+	} else
+		Instrumented(state.pq, state.stats, run);
+}
+
+
+//The Dijkstra loop behind Search, compiled once per queue type
+template<class Queue>
+void Graph::SearchWith(int src, const int *dests, int count, SearchState &state, bool reverse, Queue &pq) const{
+	StatsTimer timer(state.stats);
+	state.Prepare(numNodes);
+	int remaining = 0;                                         //destinations not settled yet
+	for(int i = 0; i < count; i++){
+		if(!state.wanted[dests[i]]){
+			state.wanted[dests[i]] = 1;
+			remaining++;
+		}
+	}
 	
-	PriorityQueue pq;              //initialize a priority queue
+	int *distFromSrc = state.distFromSrc.data();
+	int *changedby = state.changedby.data();
+	unsigned *stamp = state.stamp.data();
+	const unsigned generation = state.generation;
+	const int *rows = reverse ? revRowOffsets : rowOffsets;
+	const int *nodes = reverse ? revAdjSources : adjTargets;
+	const int *wts = reverse ? revAdjWeights : adjWeights;
 	
+	int eye = src;                 //"eyeball" index
+	int eyedist = 0;               //distance the eye is from the src
+	state.Label(src, eyedist, INT_MIN); //update this distance in the distFromSrc parallel array
 	
-	while(eye != dest){                                        //loop until we reach the destination
-		GNode* curr = adjList[eye];                                //temp variable for the adjecency we're currently "looking" at
-		while(curr){                                               //loop through all adjacencies of the current eyeball
-			if(curr->wt + eyedist <= distFromSrc[curr->adj]){          //if the distance to the current node is less than what is currently stored for that node,
-				distFromSrc[curr->adj] = curr->wt + eyedist;               //then update that value
-				pq.Enqueue(curr->adj, distFromSrc[curr->adj] );            //and add it to the priority queue
-				changedby[curr->adj] = eye;                                //also update that the current eyeball "changed us"
+	while(eye != INT_MIN){                                     //loop until the queue runs dry
+		if(state.wanted[eye]){                                     //the eyeball is settled; was it a destination?
+			state.wanted[eye] = 0;
+			if(--remaining == 0)                                       //stop once the last one is settled
+				break;
+		}
+		const int end = rows[eye+1];                               //the eyeball's adjacencies are contiguous in the CSR arrays
+		if(STATS_ENABLED){
+			state.stats.settled++;
+			state.stats.relaxed += end - rows[eye];
+		}
+		for(int e = rows[eye]; e < end; e++){                      //loop through all adjacencies of the current eyeball
+			int adj = nodes[e];                                        //the adjacency we're currently "looking" at
+			int dist = wts[e] + eyedist;
+			if(stamp[adj] != generation || dist < distFromSrc[adj]){   //if the node is new to this search, or the distance to it is less than what is currently stored for that node,
+				stamp[adj] = generation;
+				distFromSrc[adj] = dist;                                   //then update that value
+				pq.Enqueue(adj, dist);                                     //and add it to the priority queue
+				changedby[adj] = eye;                                      //also update that the current eyeball "changed us"
 			}
-			curr = curr->next;                                         //once done with the current adjacency, move to the next one
 		}                                                          //once done with all adjacencies for this eyeball,
 		eye = pq.Dequeue(eyedist);                                 //move to the next one (the node with the shortest path is dequeued) and update our distance
 	}
 	
-	cout << endl << endl << "A shortest path from " << names[src] << " to " << names[dest] << ":" << endl << endl;
-	PrintPath(src, dest);  //print the path
-	cout << endl << "This path takes approximately " << eyedist << " minutes to navigate." << endl << endl;
+	for(int i = 0; i < count; i++)                             //forget any destination we never reached
+		state.wanted[dests[i]] = 0;
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path
+//Purpose:      Find a shortest path from src to dest, using Dijkstra's algorithm, and
+//              return it without printing anything
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              state: scratch state to search in (the graph's own if not given)
+//              result: receives the cost and the path
+//Outgoing:	    result is filled in
+//Return:	    Whether dest is reachable from src
+//*****************************************************************************************
+bool Graph::FindPath(int src, int dest, PathResult &result){
+	Freeze();                      //make sure every added adjacency is searchable
+	return FindPath(src, dest, search, result);
+}
+
+bool Graph::FindPath(int src, int dest, SearchState &state, PathResult &result) const{
+	Search(src, &dest, 1, state);
+	BuildPath(src, dest, state, result);
+	return result.Found();
+}
+
+
+//*****************************************************************************************
+//Function:     Build Path
+//Purpose:      Read the path to dest out of a finished search. The "changedby" array
+//              points from dest back to src, so we count the hops first, size the path
+//              once, and then fill it from the back.
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              state: a search from src that has settled dest
+//              result: receives the cost and the path
+//Outgoing:	    result is filled in
+//Return:	    N/A-void function
+//*****************************************************************************************
+void Graph::BuildPath(int src, int dest, const SearchState &state, PathResult &result) const{
+	result.cost = state.Dist(dest);
+	if(result.cost == INT_MAX){                                //dest was never reached
+		result.path.clear();
+		return;
+	}
+	
+	int hops = 0;
+	for(int location = dest; location != src; location = state.ChangedBy(location))
+		hops++;
 	
-	Reset();               //reset the graph so we can find other shortest paths later
+	result.path.resize(hops + 1);
+	int location = dest;
+	for(int i = hops; i >= 0; i--){                            //walk back from dest, filling the path from the end
+		result.path[i] = location;
+		location = state.ChangedBy(location);
+	}
 }
 
 
 //*****************************************************************************************
-//Function:     Print Path
-//Purpose:      Print the shortest path that was found in "ShortestPath()" by using a
-//              recursive helper function to traverse the "changedby" array in reverse
-//              order, since that array points from dest to src and we want src to dest.
+//Function:     Search Bidirectional
+//Purpose:      Point-to-point Dijkstra that grows a forward frontier from src over the
+//              forward CSR and a backward frontier from dest over the reverse CSR, always
+//              advancing the side whose next node is closer. Every scanned edge that
+//              reaches a node labelled by the other side is a candidate path; the search
+//              stops once the two queue minimums add up to at least the best candidate,
+//              at which point no shorter path can exist. Like Search, it runs on bucket
+//              queues when every edge is short.
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              fwd / bwd: scratch states for the two frontiers
+//              &cost: receives the length of the shortest path (INT_MAX if none)
+//Outgoing:	    fwd.ChangedBy() leads from the meeting node back to src, and
+//              bwd.ChangedBy() leads from the meeting node on to dest
+//Return:	    The meeting node, or -1 if dest is unreachable
+//*****************************************************************************************
+int Graph::SearchBidirectional(int src, int dest, SearchState &fwd, SearchState &bwd, int &cost) const{
+	int meet = -1;
+	if(UsesBuckets() && !fwd.heapOnly){
+		fwd.buckets.SetSpan(maxWeight);
+		bwd.buckets.SetSpan(maxWeight);
+		Instrumented(fwd.buckets, fwd.stats, [&](auto &fq){
+			Instrumented(bwd.buckets, bwd.stats, [&](auto &bq){ meet = SearchBidirectionalWith(src, dest, fwd, bwd, fq, bq, cost); });
+		});
+	} else{
+		Instrumented(fwd.pq, fwd.stats, [&](auto &fq){
+			Instrumented(bwd.pq, bwd.stats, [&](auto &bq){ meet = SearchBidirectionalWith(src, dest, fwd, bwd, fq, bq, cost); });
+		});
+	}
+	return meet;
+}
+
+template<class Queue>
+int Graph::SearchBidirectionalWith(int src, int dest, SearchState &fwd, SearchState &bwd, Queue &fq, Queue &bq, int &cost) const{
+	StatsTimer fwdTimer(fwd.stats), bwdTimer(bwd.stats);
+	fwd.Prepare(numNodes);
+	bwd.Prepare(numNodes);
+	fwd.Label(src, 0, INT_MIN);
+	bwd.Label(dest, 0, INT_MIN);
+	cost = INT_MAX;
+	if(src == dest){
+		cost = 0;
+		return src;
+	}
+	
+	long long best = INT_MAX;                                  //length of the best path seen so far
+	int meet = -1;                                             //where that path crosses from one side to the other
+	fq.Enqueue(src, 0);
+	bq.Enqueue(dest, 0);
+	
+	while((long long)fq.TopDistance() + bq.TopDistance() < best){  //an empty queue counts as INT_MAX
+		bool forward = fq.TopDistance() <= bq.TopDistance();
+		SearchState &side = forward ? fwd : bwd;
+		SearchState &other = forward ? bwd : fwd;
+		Queue &queue = forward ? fq : bq;
+		const int *rows = forward ? rowOffsets : revRowOffsets;
+		const int *nodes = forward ? adjTargets : revAdjSources;
+		const int *wts = forward ? adjWeights : revAdjWeights;
+		
+		int eyedist = 0;
+		int eye = queue.Dequeue(eyedist);                          //settle the closer of the two frontiers
+		const int end = rows[eye+1];
+		if(STATS_ENABLED){
+			side.stats.settled++;
+			side.stats.relaxed += end - rows[eye];
+		}
+		for(int e = rows[eye]; e < end; e++){
+			int adj = nodes[e];
+			int dist = wts[e] + eyedist;
+			if(!side.Reached(adj) || dist < side.distFromSrc[adj]){
+				side.Label(adj, dist, eye);
+				queue.Enqueue(adj, dist);
+			}
+			if(other.Reached(adj) && dist + (long long)other.distFromSrc[adj] < best){ //the frontiers touch here
+				best = dist + (long long)other.distFromSrc[adj];
+				meet = adj;
+			}
+		}
+	}
+	
+	if(meet >= 0)
+		cost = (int)best;
+	return meet;
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path Bidirectional
+//Purpose:      Find a shortest path from src to dest with a bidirectional search and
+//              stitch the two halves together at the meeting node
 //Incoming:     src: the index of the starting node
 //              dest: the index of the destination node
+//              fwd / bwd: scratch states (the graph's own if not given)
+//              result: receives the cost and the path
+//Outgoing:	    result is filled in
+//Return:	    Whether dest is reachable from src
+//*****************************************************************************************
+bool Graph::FindPathBidirectional(int src, int dest, PathResult &result){
+	Freeze();
+	return FindPathBidirectional(src, dest, search, searchBack, result);
+}
+
+bool Graph::FindPathBidirectional(int src, int dest, SearchState &fwd, SearchState &bwd, PathResult &result) const{
+	int meet = SearchBidirectional(src, dest, fwd, bwd, result.cost);
+	if(meet < 0){
+		result.path.clear();
+		return false;
+	}
+	
+	int before = 0;                                            //hops from src to the meeting node
+	for(int location = meet; location != src; location = fwd.ChangedBy(location))
+		before++;
+	int after = 0;                                             //hops from the meeting node to dest
+	for(int location = meet; location != dest; location = bwd.ChangedBy(location))
+		after++;
+	
+	result.path.resize(before + after + 1);
+	int location = meet;
+	for(int i = before; i >= 0; i--){                          //first half, filled from the meeting node back
+		result.path[i] = location;
+		location = fwd.ChangedBy(location);
+	}
+	location = meet;
+	for(int i = before + 1; i <= before + after; i++){         //second half, following the backward links forward
+		location = bwd.ChangedBy(location);
+		result.path[i] = location;
+	}
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Shortest Path
+//Purpose:      Find a shortest path from src to dest, using Dijkstra's algorithm.
+//              Then print this path for the user. The graph's own search state and
+//              result buffer are reused, so a warmed-up query does not allocate.
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              mode: which search to run
 //Outgoing:	    Printing the path to the screen
 //Return:	    N/A-void function
 //Authors:	    Joshua Brown, Tay Cavett, Jalyn Cosby, Whittney Schwarz
 //*****************************************************************************************
-void Graph::PrintPath(int src, int dest){
-	PrintPathHelper(dest, src, dest);
+void Graph::ShortestPath(int src, int dest, SearchMode mode){
+	if(mode == BIDIRECTIONAL){
+		FindPathBidirectional(src, dest, answer);
+		lastStats = search.stats;
+		lastStats.Merge(searchBack.stats);
+	} else{
+		FindPath(src, dest, answer);
+		lastStats = search.stats;
+	}
+	Report(src, dest, answer, cout);
 }
 
 
 //*****************************************************************************************
-//Function:     Print Path Helper
-//Purpose:      Recursive helper to the "PrintPath()" function.
-//Incoming:     location: variable to help iterate through the "changedby" array
-//              src: the index of the starting node
+//Function:     Report
+//Purpose:      Print a found path (or the lack of one) the way ShortestPath presents it
+//Incoming:     src: the index of the starting node
 //              dest: the index of the destination node
-//Outgoing:	    Print a single location's name, depending on the current state of recursion
+//              result: the answer to print
+//              out: the stream to print to
+//Outgoing:	    Printing the answer to the stream
+//Return:	    N/A-void function
+//*****************************************************************************************
+void Graph::Report(int src, int dest, const PathResult &result, ostream &out) const{
+	if(!result.Found()){                                       //the queue ran dry before we reached the destination
+		out << endl << endl << "There is no path from ";
+		PrintName(src, out);
+		out << " to ";
+		PrintName(dest, out);
+		out << "." << endl << endl;
+		return;
+	}
+	
+	out << endl << endl << "A shortest path from ";
+	PrintName(src, out);
+	out << " to ";
+	PrintName(dest, out);
+	out << ":" << endl << endl;
+	PrintPath(result, out);  //print the path
+	out << endl << "This path takes approximately " << result.cost << " minutes to navigate." << endl << endl;
+}
+
+
+//*****************************************************************************************
+//Function:     Print Path
+//Purpose:      Print the stops of a path, one per line, from src to dest
+//Incoming:     result: a path returned by FindPath
+//              out: the stream to print to
+//Outgoing:	    Printing the path to the stream
 //Return:	    N/A-void function
 //Authors:	    Joshua Brown, Tay Cavett, Jalyn Cosby, Whittney Schwarz
 //*****************************************************************************************
-void Graph::PrintPathHelper(int location, int src, int dest){
-	if(location == src)                                        //if we've reached the source, we're done
-		cout << names[location] << endl;                           //and we can print out the name of the location
-	else{                                                      //if we haven't reached the source yet
-		PrintPathHelper(changedby[location], src, dest);           //recurse down
-		cout << "to" << endl;
-		cout << names[location] << endl;                           //then print the name of the current location
+void Graph::PrintPath(const PathResult &result, ostream &out) const{
+	for(size_t i = 0; i < result.path.size(); i++){
+		if(i > 0)
+			out << "to" << endl;
+		PrintName(result.path[i], out);                            //print the name of each location in order
+		out << endl;
 	}
 }
 
 
+//*****************************************************************************************
+//Function:     Search A*
+//Purpose:      A* search from src to dest. The queue is ordered by distance so far plus
+//              the heuristic's lower bound on the distance left, so the search is pulled
+//              towards dest. Heuristic is a policy class chosen at compile time with
+//                  void SetTarget(int dest);       called once per query
+//                  int Estimate(int node) const;   lower bound on the distance to dest
+//              and must be consistent (never overestimate, even edge by edge), which every
+//              heuristic in Heuristics.h is. Then settled nodes are final, just as in
+//              Dijkstra's algorithm.
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              h: the heuristic (set to dest by this call)
+//              state: the scratch state to search in
+//Outgoing:	    state.Dist() / state.ChangedBy() are final for dest and every settled node
+//Return:	    N/A-void function
+//*****************************************************************************************
+template<class Heuristic>
+void Graph::SearchAStar(int src, int dest, Heuristic &h, SearchState &state) const{
+	Instrumented(state.pq, state.stats, [&](auto &pq){ SearchAStarWith(src, dest, h, state, pq); });
+}
+
+template<class Heuristic, class Queue>
+void Graph::SearchAStarWith(int src, int dest, Heuristic &h, SearchState &state, Queue &pq) const{
+	StatsTimer timer(state.stats);
+	state.Prepare(numNodes);
+	h.SetTarget(dest);
+	
+	int *distFromSrc = state.distFromSrc.data();
+	
+	int eye = src;                 //"eyeball" index
+	int key;                       //distance so far plus estimate, as dequeued
+	state.Label(src, 0, INT_MIN);
+	
+	while(eye != INT_MIN && eye != dest){                      //loop until we reach the destination or run dry
+		int eyedist = distFromSrc[eye];
+		const int end = rowOffsets[eye+1];
+		if(STATS_ENABLED){
+			state.stats.settled++;
+			state.stats.relaxed += end - rowOffsets[eye];
+		}
+		for(int e = rowOffsets[eye]; e < end; e++){
+			int adj = adjTargets[e];
+			int dist = adjWeights[e] + eyedist;
+			if(!state.Reached(adj) || dist < distFromSrc[adj]){
+				state.Label(adj, dist, eye);
+				pq.Enqueue(adj, dist + h.Estimate(adj));               //queued by its estimated total
+			}
+		}
+		eye = pq.Dequeue(key);
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path A*
+//Purpose:      Find a shortest path from src to dest with an A* search
+//Incoming:     src: the index of the starting node
+//              dest: the index of the destination node
+//              h: the heuristic to guide the search
+//              state: scratch state to search in
+//              result: receives the cost and the path
+//Outgoing:	    result is filled in
+//Return:	    Whether dest is reachable from src
+//*****************************************************************************************
+template<class Heuristic>
+bool Graph::FindPathAStar(int src, int dest, Heuristic &h, SearchState &state, PathResult &result) const{
+	SearchAStar(src, dest, h, state);
+	BuildPath(src, dest, state, result);
+	return result.Found();
+}
+
+
 #endif
@@ -2,18 +2,130 @@
 #include <string>
 #include <fstream>
 #include <limits>
+#include <csignal>
 #include "Graph.h"
+#include "GraphLoader.h"
+#include "GraphSnapshot.h"
+#include "Heuristics.h"
+#include "ContractionHierarchy.h"
+#include "AllPairs.h"
+#include "QueryCache.h"
+#include "QueryServer.h"
 using namespace std;
 
 
 void BuildGraph(Graph &graph);
 void Menu(Graph &g);
+void StopServing(int);
 
+QueryServer *server = NULL;    //the server --serve is running, for the signal handler
 
-int main(){
+
+//*****************************************************************************************
+//Usage:        GraphDriver                         (our real-world proposal)
+//              GraphDriver <edge file> [name file] (a network loaded from disk)
+//              GraphDriver --snapshot <file>       (a network mapped from a snapshot)
+//
+//              --verify-snapshot checksums and range-checks a --snapshot before using it.
+//              --save-snapshot <file> writes the loaded network to a snapshot and exits.
+//              --all-pairs <file> writes the full distance and next-hop matrices and exits.
+//              --bidirectional searches from both ends of each query.
+//              --coords <file> runs A* guided by straight-line distance.
+//              --landmarks <count> runs A* guided by ALT landmark bounds.
+//              --ch preprocesses a contraction hierarchy and queries it.
+//              --serve <port> answers queries over TCP on 127.0.0.1 (see QueryServer.h)
+//              until interrupted, instead of prompting.
+//*****************************************************************************************
+int main(int argc, char *argv[]){
+	string snapshotIn, snapshotOut, matrixOut;
+	bool verifySnapshot = false;
+	vector<string> files;
+	SearchMode mode = DIJKSTRA;
+	string coordFile;
+	int landmarkCount = 0;
+	bool useHierarchy = false;
+	int servePort = -1;
+	for(int i = 1; i < argc; i++){
+		string arg = argv[i];
+		if(arg == "--snapshot" && i + 1 < argc)
+			snapshotIn = argv[++i];
+		else if(arg == "--verify-snapshot")
+			verifySnapshot = true;
+		else if(arg == "--save-snapshot" && i + 1 < argc)
+			snapshotOut = argv[++i];
+		else if(arg == "--all-pairs" && i + 1 < argc)
+			matrixOut = argv[++i];
+		else if(arg == "--bidirectional")
+			mode = BIDIRECTIONAL;
+		else if(arg == "--coords" && i + 1 < argc)
+			coordFile = argv[++i];
+		else if(arg == "--landmarks" && i + 1 < argc)
+			landmarkCount = atoi(argv[++i]);
+		else if(arg == "--ch")
+			useHierarchy = true;
+		else if(arg == "--serve" && i + 1 < argc)
+			servePort = atoi(argv[++i]);
+		else
+			files.push_back(arg);
+	}
+	
 	Graph g;               //initialize graph
-	BuildGraph(g);         //fill graph with data from our real-world proposal
+	if(!snapshotIn.empty()){                                   //map a prebuilt snapshot
+		if(!LoadSnapshot(snapshotIn, g, verifySnapshot))
+			return 1;
+	} else if(!files.empty()){                                 //load a real network if one was given
+		if(!LoadGraph(files[0], files.size() > 1 ? files[1] : "", g))
+			return 1;
+	} else
+		BuildGraph(g);     //otherwise fill graph with data from our real-world proposal
+	
+	if(!snapshotOut.empty())
+		return SaveSnapshot(g, snapshotOut) ? 0 : 1;
+	if(!matrixOut.empty()){
+		DistanceMatrix matrix;
+		if(!matrix.Compute(g, true))
+			return 1;
+		return matrix.Save(matrixOut) ? 0 : 1;
+	}
+	g.Freeze();
+	if(servePort >= 0){
+		QueryServer queryServer(g);
+		if(!queryServer.Listen(servePort))
+			return 1;
+		server = &queryServer;
+		signal(SIGINT, StopServing);
+		signal(SIGTERM, StopServing);
+		cout << "Serving " << g.NumNodes() << " stops on 127.0.0.1:" << queryServer.Port() << endl;
+		queryServer.Run();
+		server = NULL;
+		cout << "Answered " << queryServer.Served() << " queries in " << queryServer.Batches() << " batches." << endl;
+		return 0;
+	}
+	
+	if(g.NumNodes() == 0){                                     //every query below needs a stop to default to
+		cerr << "Err: the network has no stops to route between" << endl;
+		return 1;
+	}
 	
+	vector<int> x, y;                                          //optional A* guidance
+	if(!coordFile.empty() && !LoadCoordinates(coordFile, g.NumNodes(), x, y))
+		return 1;
+	unique_ptr<CoordinateHeuristic> coords;
+	if(!coordFile.empty())
+		coords.reset(new CoordinateHeuristic(g, x, y));
+	unique_ptr<LandmarkTable> landmarkTable;
+	unique_ptr<LandmarkHeuristic> landmarks;
+	if(landmarkCount > 0){
+		landmarkTable.reset(new LandmarkTable(g, landmarkCount));
+		landmarks.reset(new LandmarkHeuristic(*landmarkTable));
+	}
+	unique_ptr<ContractionHierarchy> hierarchy;
+	if(useHierarchy)
+		hierarchy.reset(new ContractionHierarchy(g));
+	QueryCache cache(g);                                       //repeated queries skip the search
+	SearchState state;
+	HierarchyState hierarchyState;
+	PathResult result;
 	
     int src = 0;
 	int dest = 0;
@@ -24,27 +136,66 @@ int main(){
 		cin >> src;
 		if(src == -1)
 			break;
-		else if( !(src >= 0 && src < SIZE) ){
+		else if( !(src >= 0 && src < g.NumNodes()) ){
 			cout << "Not a valid input. option 0 chosen by default." << endl << endl;
 			src = 0;
 		}
-		cout << "Starting at " << g.GetName(src) << "." << endl;
+		cout << "Starting at ";
+		g.PrintName(src, cout);
+		cout << "." << endl;
 		cout << "Now, choose a destination(-1 to quit): ";
 		cin >> dest;
 		if(dest == -1)
 			break;
-		else if( !(dest >= 0 && dest < SIZE) ){
-			cout << "Not a valid input. option 6 chosen by default." << endl << endl;
-			src = 6;
+		else if( !(dest >= 0 && dest < g.NumNodes()) ){
+			dest = g.NumNodes() - 1;
+			cout << "Not a valid input. option " << dest << " chosen by default." << endl << endl;
+		}
+		AllocationScope allocations;                               //only counts when built with -DCOUNT_ALLOCATIONS
+		const SearchStats *work = NULL;                            //only filled in when built with -DSEARCH_STATS
+		if(hierarchy){
+			hierarchy->FindPath(src, dest, hierarchyState, result);
+			g.Report(src, dest, result, cout);
+		} else if(landmarks){
+			g.FindPathAStar(src, dest, *landmarks, state, result);
+			g.Report(src, dest, result, cout);
+			work = &state.stats;
+		} else if(coords){
+			g.FindPathAStar(src, dest, *coords, state, result);
+			g.Report(src, dest, result, cout);
+			work = &state.stats;
+		} else if(mode == DIJKSTRA){
+			unsigned long long misses = cache.Stats().misses;
+			cache.FindPath(src, dest, state, result);
+			g.Report(src, dest, result, cout);
+			if(cache.Stats().misses != misses)                     //a cache hit did no search
+				work = &state.stats;
+		} else{
+			g.ShortestPath(src, dest, mode);
+			work = &g.LastStats();
 		}
-		g.ShortestPath(src, dest);
+		if(ALLOCATIONS_COUNTED)
+			cout << "Heap allocations for this query: " << allocations.Count() << endl;
+		if(STATS_ENABLED && work)
+			work->Print(cout);
 	}
 	
+	CacheStats stats = cache.Stats();
+	if(stats.Lookups() > 0)
+		cout << endl << "Cache: " << stats.pathHits + stats.treeHits << " of " << stats.Lookups() << " queries answered without a search." << endl;
     return 0;
 }
 
 
 void BuildGraph(Graph &graph){
+	graph.AddNode("Empire State Building");		//0
+	graph.AddNode("Penn Station");				//1
+	graph.AddNode("Rector Street Station");		//2
+	graph.AddNode("9/11 Memorial");				//3
+	graph.AddNode("Wall Street Station");		//4
+	graph.AddNode("Grand Army Plaza Station");	//5
+	graph.AddNode("Grand Army Plaza");			//6
+	
 	graph.AddAdj(0,7,1);
 	graph.AddAdj(0,20,3);
 	graph.AddAdj(0,39,6);
@@ -67,9 +218,22 @@ void BuildGraph(Graph &graph){
 }
 
 
+void StopServing(int){
+	if(server)
+		server->Stop();
+}
+
+
 void Menu(Graph &g){
 	cout << "Menu" << endl;
-	for(int i = 0; i < SIZE; i++)
-		cout << "#" << i << ": " << g.GetName(i) << endl;
+	if(g.NumNodes() > 50){ //too many stops to list them all
+		cout << "Stops are numbered #0 to #" << g.NumNodes() - 1 << endl;
+		return;
+	}
+	for(int i = 0; i < g.NumNodes(); i++){
+		cout << "#" << i << ": ";
+		g.PrintName(i, cout);
+		cout << endl;
+	}
 }
     
@@ -0,0 +1,197 @@
+#ifndef _GRAPHGENERATORS_H
+#define _GRAPHGENERATORS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+//*****************************************************************************************
+//Synthetic networks for benchmarks and tests. Every generator is a pure function of its
+//arguments and seed: the random numbers come from SplitMix64 below rather than the
+//standard distributions, whose output differs between library versions, so the same
+//call builds the same graph on every machine. Each generator adds to an empty graph,
+//makes every connection two-way, and leaves the graph frozen.
+//*****************************************************************************************
+
+
+//********************************
+//SplitMix64 Struct
+//********************************
+//Small, fast, fully specified 64-bit generator (Steele, Lea and Flood).
+struct SplitMix64{
+	uint64_t state;
+
+	explicit SplitMix64(uint64_t seed):state(seed){};
+	uint64_t Next(){
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+	int Below(int n){ return (int)(Next() % (uint64_t)n); }     //uniform-enough in [0, n)
+	int Between(int lo, int hi){ return lo + Below(hi - lo + 1); } //in [lo, hi]
+};
+
+
+//*****************************************************************************************
+//Function:     Make Grid
+//Purpose:      Build a road-like grid: every node links to its four neighbours with a
+//              random travel time. A small share of the links is left out so that
+//              shortest paths have to detour, the way real street networks make them.
+//Incoming:     g: an empty graph
+//              rows / cols: grid size (rows * cols nodes, node r*cols + c)
+//              maxWeight: travel times are drawn from [1, maxWeight]
+//              seed: random seed
+//Outgoing:     g holds the grid and is frozen
+//Return:       N/A-void function
+//*****************************************************************************************
+void MakeGrid(Graph &g, int rows, int cols, int maxWeight, uint64_t seed){
+	SplitMix64 rng(seed);
+	g.Reserve(rows * cols, 4 * rows * cols);
+	g.Resize(rows * cols);
+	for(int r = 0; r < rows; r++){
+		for(int c = 0; c < cols; c++){
+			int v = r * cols + c;
+			if(c + 1 < cols && rng.Below(20) != 0){    //about one street in twenty is missing
+				int wt = rng.Between(1, maxWeight);
+				g.AddAdj(v, wt, v + 1);
+				g.AddAdj(v + 1, wt, v);
+			}
+			if(r + 1 < rows && rng.Below(20) != 0){
+				int wt = rng.Between(1, maxWeight);
+				g.AddAdj(v, wt, v + cols);
+				g.AddAdj(v + cols, wt, v);
+			}
+		}
+	}
+	g.Freeze();
+}
+
+
+//*****************************************************************************************
+//Function:     Make Geometric
+//Purpose:      Build a random geometric graph: nodes are scattered over a square and
+//              every pair closer than a radius is linked, weighted by its rounded-up
+//              distance. The square grows with n so the density, and so the average
+//              degree, stays fixed. Pairs are found through a grid of radius-sized cells,
+//              so the cost is linear in the size of the graph.
+//Incoming:     g: an empty graph
+//              nodes: number of nodes
+//              degree: the average number of neighbours wanted
+//              seed: random seed
+//              x / y: receive the coordinates (usable with CoordinateHeuristic)
+//Outgoing:     g holds the graph and is frozen
+//Return:       N/A-void function
+//*****************************************************************************************
+void MakeGeometric(Graph &g, int nodes, double degree, uint64_t seed, vector<int> &x, vector<int> &y){
+	SplitMix64 rng(seed);
+	const double spacing = 100.0;                           //mean distance between neighbouring points
+	int side = max(1, (int)(sqrt((double)nodes) * spacing));
+	double radius = spacing * sqrt(degree / M_PI);          //pi r^2 covers "degree" points on average
+	x.resize(nodes);
+	y.resize(nodes);
+	for(int v = 0; v < nodes; v++){
+		x[v] = rng.Below(side);
+		y[v] = rng.Below(side);
+	}
+
+	int cells = max(1, (int)(side / radius));               //cells at least one radius wide
+	double cellSize = (double)side / cells;
+	vector<int> cellStart(cells * cells + 1, 0), members(nodes);
+	vector<int> cellOf(nodes);
+	for(int v = 0; v < nodes; v++){                         //bucket the points by cell with a counting sort
+		int cx = min(cells - 1, (int)(x[v] / cellSize));
+		int cy = min(cells - 1, (int)(y[v] / cellSize));
+		cellOf[v] = cy * cells + cx;
+		cellStart[cellOf[v] + 1]++;
+	}
+	for(int c = 0; c < cells * cells; c++)
+		cellStart[c+1] += cellStart[c];
+	vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+	for(int v = 0; v < nodes; v++)
+		members[fill[cellOf[v]]++] = v;
+
+	g.Reserve(nodes, (int)(nodes * degree * 1.1));
+	g.Resize(nodes);
+	double limit = radius * radius;
+	for(int v = 0; v < nodes; v++){
+		int cx = cellOf[v] % cells, cy = cellOf[v] / cells;
+		for(int ny = max(0, cy - 1); ny <= min(cells - 1, cy + 1); ny++){
+			for(int nx = max(0, cx - 1); nx <= min(cells - 1, cx + 1); nx++){
+				int c = ny * cells + nx;
+				for(int k = cellStart[c]; k < cellStart[c+1]; k++){
+					int u = members[k];
+					if(u <= v)                                      //each pair once, from its smaller end
+						continue;
+					double dx = x[u] - x[v], dy = y[u] - y[v];
+					double d2 = dx * dx + dy * dy;
+					if(d2 > limit)
+						continue;
+					int wt = max(1, (int)ceil(sqrt(d2)));
+					g.AddAdj(v, wt, u);
+					g.AddAdj(u, wt, v);
+				}
+			}
+		}
+	}
+	g.Freeze();
+}
+
+
+//*****************************************************************************************
+//Function:     Make Scale Free
+//Purpose:      Build a scale-free graph by Barabasi-Albert preferential attachment: each
+//              new node links to "links" distinct earlier nodes picked with probability
+//              proportional to their degree, which gives the few very busy hubs that
+//              transfer networks have. Picking from a list holding every edge endpoint
+//              makes each pick O(1).
+//Incoming:     g: an empty graph
+//              nodes: number of nodes
+//              links: links added with every new node
+//              maxWeight: travel times are drawn from [1, maxWeight]
+//              seed: random seed
+//Outgoing:     g holds the graph and is frozen
+//Return:       N/A-void function
+//*****************************************************************************************
+void MakeScaleFree(Graph &g, int nodes, int links, int maxWeight, uint64_t seed){
+	SplitMix64 rng(seed);
+	links = max(1, links);
+	int core = min(nodes, links + 1);                       //start from a small complete graph
+	vector<int> endpoints;
+	endpoints.reserve(2 * (size_t)nodes * links);
+	g.Reserve(nodes, 2 * nodes * links);
+	g.Resize(nodes);
+	for(int v = 0; v < core; v++){
+		for(int u = v + 1; u < core; u++){
+			int wt = rng.Between(1, maxWeight);
+			g.AddAdj(v, wt, u);
+			g.AddAdj(u, wt, v);
+			endpoints.push_back(v);
+			endpoints.push_back(u);
+		}
+	}
+
+	vector<int> picked;
+	for(int v = core; v < nodes; v++){
+		picked.clear();
+		while((int)picked.size() < links){
+			int u = endpoints[rng.Below((int)endpoints.size())];
+			if(find(picked.begin(), picked.end(), u) == picked.end())
+				picked.push_back(u);
+		}
+		for(size_t k = 0; k < picked.size(); k++){
+			int wt = rng.Between(1, maxWeight);
+			g.AddAdj(v, wt, picked[k]);
+			g.AddAdj(picked[k], wt, v);
+			endpoints.push_back(v);
+			endpoints.push_back(picked[k]);
+		}
+	}
+	g.Freeze();
+}
+
+
+#endif
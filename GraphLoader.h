@@ -0,0 +1,357 @@
+#ifndef _GRAPHLOADER_H
+#define _GRAPHLOADER_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Graph.h"
+using namespace std;
+
+//*****************************************************************************************
+//Edge-list file format (whitespace separated, lines starting with '#' are comments):
+//
+//    <node count> <edge count>
+//    <from> <to> <weight>
+//    ...
+//
+//Name file format: one name per line, line i names node i.
+//
+//Coordinate file format: one "<x> <y>" integer pair per node, in node order.
+//*****************************************************************************************
+
+
+//********************************
+//Chunk Reader Class Header
+//********************************
+//Reads a file through one large buffer that is refilled in place, so parsing never
+//allocates per line and each byte of the file is copied at most twice.
+class ChunkReader{
+	FILE *file;                                //the open file (or NULL)
+	vector<char> buffer;                       //current chunk of the file
+	size_t pos;                                //next unread byte in buffer
+	size_t len;                                //number of valid bytes in buffer
+	bool eof;                                  //has the whole file been read into buffer?
+	bool overflow;                             //did the last NextInt stop on a number too large for an int?
+
+	bool Refill();                             //keep the unread tail, read more behind it
+	bool SkipSpace();                          //skip whitespace and comment lines
+
+public:
+	ChunkReader(const string &path, size_t chunk = 1 << 20);
+	~ChunkReader();
+	bool IsOpen() const { return file != NULL; }
+	size_t FileSize() const;                   //size of the whole file in bytes
+	bool NextInt(int &value);                  //parse the next integer
+	bool Overflowed() const { return overflow; } //why the last NextInt failed, if it did
+	bool NextLine(const char *&line, int &length); //next line, valid until the next call
+};
+
+
+ChunkReader::ChunkReader(const string &path, size_t chunk):buffer(chunk),pos(0),len(0),eof(false),overflow(false){
+	file = fopen(path.c_str(), "rb");
+}
+
+ChunkReader::~ChunkReader(){
+	if(file)
+		fclose(file);
+}
+
+
+size_t ChunkReader::FileSize() const{
+	struct stat info;
+	if(!file || fstat(fileno(file), &info) != 0 || info.st_size < 0)
+		return 0;
+	return (size_t)info.st_size;
+}
+
+
+//*****************************************************************************************
+//Function:     Refill
+//Purpose:      Move the unread bytes to the front of the buffer and fill the rest of it
+//              from the file. The buffer doubles if it is already full of unread bytes.
+//Incoming:     N/A
+//Outgoing:     buffer/pos/len updated, eof set once the file is exhausted
+//Return:       Whether any new bytes were read
+//*****************************************************************************************
+bool ChunkReader::Refill(){
+	if(eof || !file)
+		return false;
+	size_t keep = len - pos;
+	if(keep > 0 && pos > 0)
+		memmove(&buffer[0], &buffer[pos], keep);
+	pos = 0;
+	len = keep;
+	if(len == buffer.size())                   //a single token or line fills the whole buffer
+		buffer.resize(buffer.size() * 2);
+	size_t got = fread(&buffer[len], 1, buffer.size() - len, file);
+	len += got;
+	if(got == 0)
+		eof = true;
+	return got > 0;
+}
+
+
+//*****************************************************************************************
+//Function:     Skip Space
+//Purpose:      Advance past whitespace and '#' comment lines
+//Incoming:     N/A
+//Outgoing:     pos is at the first byte of the next token
+//Return:       Whether there is a token left in the file
+//*****************************************************************************************
+bool ChunkReader::SkipSpace(){
+	while(true){
+		if(pos == len && !Refill())
+			return false;
+		char c = buffer[pos];
+		if(c == '#'){                              //comment: skip to the end of the line
+			while(true){
+				const char *nl = (const char *)memchr(&buffer[pos], '\n', len - pos);
+				if(nl){
+					pos = nl - &buffer[0];
+					break;
+				}
+				pos = len;
+				if(!Refill())
+					return false;
+			}
+		} else if(c == ' ' || c == '\t' || c == '\r' || c == '\n')
+			pos++;
+		else
+			return true;
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Next Int
+//Purpose:      Parse the next (optionally negative) decimal integer in the file. A number
+//              outside the range of an int is consumed but rejected, with Overflowed set,
+//              rather than wrapped around into some other valid-looking value.
+//Incoming:     &value: receives the parsed integer
+//Outgoing:     pos is moved past the integer
+//Return:       Whether an integer that fits in an int was read
+//*****************************************************************************************
+bool ChunkReader::NextInt(int &value){
+	overflow = false;
+	if(!SkipSpace())
+		return false;
+
+	bool negative = false;
+	if(buffer[pos] == '-'){
+		negative = true;
+		pos++;
+	}
+
+	const long long limit = negative ? -(long long)INT_MIN : INT_MAX;
+	long long result = 0;
+	int digits = 0;
+	while(pos < len || Refill()){              //a number may straddle two chunks
+		char c = buffer[pos];
+		if(c < '0' || c > '9')
+			break;
+		if(!overflow){                         //stop accumulating once out of range, so result cannot overflow either
+			result = result * 10 + (c - '0');
+			overflow = result > limit;
+		}
+		digits++;
+		pos++;
+	}
+	if(overflow)
+		return false;
+	value = (int)(negative ? -result : result);
+	return digits > 0;
+}
+
+
+//*****************************************************************************************
+//Function:     Next Line
+//Purpose:      Hand back the next line of the file without copying it out of the buffer
+//Incoming:     &line, &length: receive the start and length of the line (no '\n' or '\r')
+//Outgoing:     pos is moved to the start of the following line
+//Return:       Whether a line was read
+//*****************************************************************************************
+bool ChunkReader::NextLine(const char *&line, int &length){
+	if(pos == len && !Refill())
+		return false;
+
+	const char *nl;
+	while(!(nl = (const char *)memchr(&buffer[pos], '\n', len - pos))){
+		if(!Refill()){                             //last line of the file has no newline
+			nl = &buffer[0] + len;
+			break;
+		}
+	}
+
+	line = &buffer[pos];
+	length = (int)(nl - line);
+	pos = min(len, (size_t)(nl - &buffer[0]) + 1);
+	if(length > 0 && line[length-1] == '\r')   //tolerate Windows line endings
+		length--;
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Load Names
+//Purpose:      Append one named node to the graph for every line of a name file
+//Incoming:     path: the name file
+//              graph: the graph to add nodes to
+//Outgoing:     The graph has one more node per line
+//Return:       Whether the file could be read
+//*****************************************************************************************
+bool LoadNames(const string &path, Graph &graph){
+	ChunkReader reader(path);
+	if(!reader.IsOpen()){
+		cerr << "Err: could not open name file \"" << path << "\"" << endl;
+		return false;
+	}
+
+	const char *line;
+	int length;
+	while(reader.NextLine(line, length))
+		graph.AddNode(line, length);
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Load Edges
+//Purpose:      Read the edge records that follow the header of an edge-list file
+//Incoming:     reader: positioned just after the header
+//              nodes / edges: the counts from the header
+//              graph: the graph to add adjacencies to
+//Outgoing:     The graph holds every edge and is frozen
+//Return:       Whether every record was valid
+//*****************************************************************************************
+bool LoadEdges(ChunkReader &reader, int nodes, int edges, Graph &graph){
+	try{
+		graph.Resize(nodes);
+	} catch(const bad_alloc &){                //the header asked for more nodes than fit in memory
+		cerr << "Err: not enough memory for " << nodes << " nodes" << endl;
+		return false;
+	}
+	nodes = graph.NumNodes();                  //the name file may have named more nodes than the header
+	for(int e = 0; e < edges; e++){
+		int from, to, wt;
+		if(!reader.NextInt(from) || !reader.NextInt(to) || !reader.NextInt(wt)){
+			if(reader.Overflowed()){
+				cerr << "Err: edge " << e << " has a number too large for an int" << endl;
+				return false;
+			}
+			cerr << "Err: edge list ended after " << e << " of " << edges << " edges" << endl;
+			return false;
+		}
+		if(from < 0 || from >= nodes || to < 0 || to >= nodes || wt < 0){
+			cerr << "Err: edge " << e << " (" << from << " " << to << " " << wt << ") is out of range" << endl;
+			return false;
+		}
+		graph.AddAdj(from, wt, to);
+	}
+	graph.Freeze();
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Physical Memory
+//Purpose:      Size of this machine's RAM, the most a header's counts may ask for: a larger
+//              allocation can be granted by overcommit and then kill the process when used
+//Incoming:     N/A
+//Outgoing:     N/A
+//Return:       Bytes of physical memory (SIZE_MAX if unknown)
+//*****************************************************************************************
+size_t PhysicalMemory(){
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGE_SIZE);
+	if(pages <= 0 || pageSize <= 0)
+		return SIZE_MAX;
+	return (size_t)pages * (size_t)pageSize;
+}
+
+
+//*****************************************************************************************
+//Function:     Load Graph
+//Purpose:      Build a graph from an edge-list file and an optional name file. Storage is
+//              pre-sized from the header counts, so loading is linear in the file size.
+//              The counts are only trusted as far as the file could hold them, and a
+//              header that cannot be met is reported rather than allowed to abort.
+//Incoming:     edgePath: the edge-list file
+//              namePath: the name file, or "" for unnamed nodes
+//              graph: an empty graph to fill
+//Outgoing:     The graph holds the network described by the files
+//Return:       Whether both files were read successfully
+//*****************************************************************************************
+bool LoadGraph(const string &edgePath, const string &namePath, Graph &graph){
+	ChunkReader reader(edgePath);
+	if(!reader.IsOpen()){
+		cerr << "Err: could not open edge file \"" << edgePath << "\"" << endl;
+		return false;
+	}
+
+	int nodes, edges;
+	if(!reader.NextInt(nodes) || !reader.NextInt(edges) || nodes < 0 || edges < 0){
+		if(reader.Overflowed()){
+			cerr << "Err: \"" << edgePath << "\" has a node or edge count too large for an int" << endl;
+			return false;
+		}
+		cerr << "Err: \"" << edgePath << "\" does not start with a node and edge count" << endl;
+		return false;
+	}
+	if(nodes == INT_MAX){                      //node indices must stay below the node count
+		cerr << "Err: \"" << edgePath << "\" has more nodes than a graph can index" << endl;
+		return false;
+	}
+	if(3 * sizeof(int) * ((size_t)nodes + 1) > PhysicalMemory()){   //names, rows and reverse rows
+		cerr << "Err: \"" << edgePath << "\" has " << nodes << " nodes, more than memory can hold" << endl;
+		return false;
+	}
+	size_t records = reader.FileSize() / 6 + 1;   //the shortest edge record, "0 0 0\n", is six bytes
+	graph.Reserve((int)min((size_t)nodes, records), (int)min((size_t)edges, records));  //the counts are only hints
+
+	if(!namePath.empty() && !LoadNames(namePath, graph))
+		return false;
+	return LoadEdges(reader, nodes, edges, graph);
+}
+
+
+//*****************************************************************************************
+//Function:     Load Coordinates
+//Purpose:      Read one integer coordinate pair per node for the coordinate heuristic
+//Incoming:     path: the coordinate file
+//              nodes: how many pairs to read
+//              x / y: receive the coordinates
+//Outgoing:     x and y hold "nodes" entries each
+//Return:       Whether every pair was read
+//*****************************************************************************************
+bool LoadCoordinates(const string &path, int nodes, vector<int> &x, vector<int> &y){
+	ChunkReader reader(path);
+	if(!reader.IsOpen()){
+		cerr << "Err: could not open coordinate file \"" << path << "\"" << endl;
+		return false;
+	}
+
+	x.resize(nodes);
+	y.resize(nodes);
+	for(int i = 0; i < nodes; i++){
+		if(!reader.NextInt(x[i]) || !reader.NextInt(y[i])){
+			if(reader.Overflowed()){
+				cerr << "Err: coordinate " << i << " has a number too large for an int" << endl;
+				return false;
+			}
+			cerr << "Err: coordinate file ended after " << i << " of " << nodes << " nodes" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+
+#endif
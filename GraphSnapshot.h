@@ -0,0 +1,352 @@
+#ifndef _GRAPHSNAPSHOT_H
+#define _GRAPHSNAPSHOT_H
+
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Graph.h"
+using namespace std;
+
+//*****************************************************************************************
+//Binary snapshot layout (native byte order, every section starts on a 64-byte boundary):
+//
+//    SnapshotHeader
+//    int  offsets[nodes+1]        CSR row offsets
+//    int  targets[edges]          CSR adjacency
+//    int  weights[edges]          CSR weight
+//    int  revOffsets[nodes+1]     reverse CSR row offsets
+//    int  revSources[edges]       reverse CSR source of each arriving edge
+//    int  revWeights[edges]       reverse CSR weight
+//    int  nameOffsets[nodes+1]    name i is names[nameOffsets[i], nameOffsets[i+1])
+//    char names[nameBytes]
+//
+//The header carries its own checksum, which is always verified. The payload checksum
+//covers every byte after the header and is only verified on request, because reading
+//the whole file would defeat the point of mapping it.
+//*****************************************************************************************
+
+const char SNAPSHOT_MAGIC[8] = {'S','P','G','R','A','P','H','\0'};
+const uint32_t SNAPSHOT_VERSION = 3;     //2: adds the reverse CSR, 3: records the heaviest edge weight
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const uint64_t SNAPSHOT_ALIGN = 64;
+
+//********************************
+//Snapshot Header Struct
+//********************************
+struct SnapshotHeader{
+	char magic[8];                 //SNAPSHOT_MAGIC
+	uint32_t version;              //SNAPSHOT_VERSION
+	uint32_t byteOrder;            //SNAPSHOT_BYTE_ORDER as written by this machine
+	int32_t nodes;                 //number of nodes
+	int32_t edges;                 //number of edges
+	int32_t maxWeight;             //heaviest edge weight (INT32_MAX if any is negative)
+	int32_t reserved;              //zero; keeps the 64-bit fields aligned
+	uint64_t nameBytes;            //size of the name character section
+	uint64_t offsetsPos;           //file position of each section
+	uint64_t targetsPos;
+	uint64_t weightsPos;
+	uint64_t revOffsetsPos;
+	uint64_t revSourcesPos;
+	uint64_t revWeightsPos;
+	uint64_t nameOffsetsPos;
+	uint64_t namesPos;
+	uint64_t fileSize;             //total size of the file
+	uint64_t payloadChecksum;      //FNV-1a of everything after the header
+	uint64_t headerChecksum;       //FNV-1a of the header up to this field
+};
+
+
+//*****************************************************************************************
+//Function:     Checksum
+//Purpose:      64-bit FNV-1a hash of a block of bytes, continuing from "hash"
+//Incoming:     data / size: the bytes to hash
+//              hash: running value (start with the default)
+//Outgoing:     N/A
+//Return:       The updated hash
+//*****************************************************************************************
+uint64_t Checksum(const void *data, size_t size, uint64_t hash = 14695981039346656037ULL){
+	const unsigned char *bytes = (const unsigned char *)data;
+	for(size_t i = 0; i < size; i++){
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+//********************************
+//Mapped File Class Header
+//********************************
+//Read-only memory mapping of a whole file, unmapped when the last owner lets go of it.
+class MappedFile{
+	void *data;                                //start of the mapping (or NULL)
+	size_t size;                               //length of the mapping
+
+public:
+	MappedFile(const string &path);
+	~MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	bool IsOpen() const { return data != NULL; }
+	const char *Data() const { return (const char *)data; }
+	size_t Size() const { return size; }
+};
+
+
+MappedFile::MappedFile(const string &path):data(NULL),size(0){
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		return;
+	struct stat info;
+	if(fstat(fd, &info) == 0 && info.st_size > 0){
+		void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if(mapped != MAP_FAILED){
+			data = mapped;
+			size = info.st_size;
+		}
+	}
+	close(fd);                                 //the mapping stays valid after the descriptor is closed
+}
+
+MappedFile::~MappedFile(){
+	if(data)
+		munmap(data, size);
+}
+
+
+//*****************************************************************************************
+//Function:     Align Up
+//Purpose:      Round a file position up to the next section boundary
+//Incoming:     pos: a file position
+//Outgoing:     N/A
+//Return:       The aligned position
+//*****************************************************************************************
+uint64_t AlignUp(uint64_t pos){
+	return (pos + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+}
+
+
+//*****************************************************************************************
+//Function:     Save Snapshot
+//Purpose:      Write the graph to a binary snapshot file that LoadSnapshot can map
+//Incoming:     graph: the graph to save (pending adjacencies are frozen first)
+//              path: the file to write
+//Outgoing:     The snapshot file
+//Return:       Whether the file was written
+//*****************************************************************************************
+bool SaveSnapshot(Graph &graph, const string &path){
+	graph.Freeze();
+	int nodes = graph.NumNodes();
+	int edges = graph.NumEdges();
+
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = SNAPSHOT_VERSION;
+	header.byteOrder = SNAPSHOT_BYTE_ORDER;
+	header.nodes = nodes;
+	header.edges = edges;
+	header.maxWeight = graph.MaxWeight();
+	header.nameBytes = graph.NameOffsets()[nodes];
+
+	struct Section{ const void *data; uint64_t bytes; uint64_t *pos; };
+	Section sections[] = {
+		{ graph.Offsets(),        sizeof(int) * (uint64_t)(nodes + 1), &header.offsetsPos },
+		{ graph.Targets(),        sizeof(int) * (uint64_t)edges,       &header.targetsPos },
+		{ graph.Weights(),        sizeof(int) * (uint64_t)edges,       &header.weightsPos },
+		{ graph.ReverseOffsets(), sizeof(int) * (uint64_t)(nodes + 1), &header.revOffsetsPos },
+		{ graph.ReverseSources(), sizeof(int) * (uint64_t)edges,       &header.revSourcesPos },
+		{ graph.ReverseWeights(), sizeof(int) * (uint64_t)edges,       &header.revWeightsPos },
+		{ graph.NameOffsets(),    sizeof(int) * (uint64_t)(nodes + 1), &header.nameOffsetsPos },
+		{ graph.NameChars(),      header.nameBytes,                    &header.namesPos },
+	};
+	const int count = sizeof(sections) / sizeof(sections[0]);
+
+	uint64_t pos = sizeof(SnapshotHeader);               //lay the sections out and checksum the payload
+	uint64_t hash = Checksum(NULL, 0);
+	const char zeros[SNAPSHOT_ALIGN] = {0};
+	for(int i = 0; i < count; i++){
+		uint64_t start = AlignUp(pos);
+		hash = Checksum(zeros, start - pos, hash);         //padding is part of the payload
+		*sections[i].pos = start;
+		hash = Checksum(sections[i].data, sections[i].bytes, hash);
+		pos = start + sections[i].bytes;
+	}
+	header.fileSize = pos;
+	header.payloadChecksum = hash;
+	header.headerChecksum = Checksum(&header, offsetof(SnapshotHeader, headerChecksum));
+
+	FILE *file = fopen(path.c_str(), "wb");
+	if(!file){
+		cerr << "Err: could not create snapshot \"" << path << "\"" << endl;
+		return false;
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	pos = sizeof(header);
+	for(int i = 0; i < count && ok; i++){
+		uint64_t pad = *sections[i].pos - pos;
+		ok = fwrite(zeros, 1, pad, file) == pad
+		  && (sections[i].bytes == 0 || fwrite(sections[i].data, 1, sections[i].bytes, file) == sections[i].bytes);  //an empty section may have no data at all
+		pos = *sections[i].pos + sections[i].bytes;
+	}
+	if(fclose(file) != 0)
+		ok = false;
+	if(!ok)
+		cerr << "Err: could not write snapshot \"" << path << "\"" << endl;
+	return ok;
+}
+
+
+//*****************************************************************************************
+//Function:     Sections Fit
+//Purpose:      Check that a header's counts are sane and that every section it describes
+//              is aligned and lies inside the file, so nothing is read out of bounds
+//Incoming:     header: a header whose checksum has been verified
+//Outgoing:     N/A
+//Return:       Whether every section fits
+//*****************************************************************************************
+bool SectionsFit(const SnapshotHeader &header){
+	if(header.nodes < 0 || header.edges < 0 || header.nameBytes > (uint64_t)INT32_MAX)
+		return false;
+	uint64_t rows = sizeof(int) * ((uint64_t)header.nodes + 1);
+	uint64_t cells = sizeof(int) * (uint64_t)header.edges;
+	struct Section{ uint64_t pos; uint64_t bytes; };
+	const Section sections[] = {
+		{ header.offsetsPos, rows }, { header.targetsPos, cells }, { header.weightsPos, cells },
+		{ header.revOffsetsPos, rows }, { header.revSourcesPos, cells }, { header.revWeightsPos, cells },
+		{ header.nameOffsetsPos, rows }, { header.namesPos, header.nameBytes },
+	};
+	for(const Section &section : sections){
+		if(section.pos < sizeof(SnapshotHeader) || section.pos % sizeof(int) != 0 ||
+		   section.pos > header.fileSize || section.bytes > header.fileSize - section.pos)   //written so it cannot overflow
+			return false;
+	}
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Valid Rows
+//Purpose:      Check one CSR half of a snapshot the way a search will use it: offsets
+//              start at 0, never decrease and end at "edges", every index names a node,
+//              and every weight is within the maxWeight bound searches size buckets by
+//Incoming:     offsets / indices / weights: the section (weights may be NULL)
+//              nodes / edges / maxWeight: from the header
+//              indexLimit: one past the largest valid index
+//Outgoing:     N/A
+//Return:       Whether the section is safe to search
+//*****************************************************************************************
+bool ValidRows(const int *offsets, const int *indices, const int *weights,
+               int nodes, int edges, int maxWeight, int indexLimit){
+	if(offsets[0] != 0 || offsets[nodes] != edges)
+		return false;
+	for(int i = 0; i < nodes; i++){
+		if(offsets[i+1] < offsets[i])
+			return false;
+	}
+	for(int e = 0; e < edges && (indices || weights); e++){
+		if(indices && (indices[e] < 0 || indices[e] >= indexLimit))
+			return false;
+		if(weights && (weights[e] < 0 ? maxWeight != INT_MAX : weights[e] > maxWeight))
+			return false;
+	}
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Load Snapshot
+//Purpose:      Map a snapshot file and attach the graph to it without copying. Startup
+//              cost does not depend on the size of the graph, and every process that
+//              maps the same file shares one copy of it in the page cache.
+//Incoming:     path: the snapshot file
+//              graph: the graph to attach
+//              verifyPayload: also checksum every section and range-check every offset,
+//              node index and weight (reads the whole file). The checksum only catches
+//              damage after writing; the range checks also catch a faulty writer.
+//Outgoing:     The graph reads its adjacency and names from the mapped file
+//Return:       Whether the snapshot was valid
+//*****************************************************************************************
+bool LoadSnapshot(const string &path, Graph &graph, bool verifyPayload = false){
+	shared_ptr<MappedFile> file = make_shared<MappedFile>(path);
+	if(!file->IsOpen()){
+		cerr << "Err: could not map snapshot \"" << path << "\"" << endl;
+		return false;
+	}
+
+	SnapshotHeader header;
+	if(file->Size() < sizeof(header)){
+		cerr << "Err: \"" << path << "\" is too small to be a snapshot" << endl;
+		return false;
+	}
+	memcpy(&header, file->Data(), sizeof(header));
+	if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0){
+		cerr << "Err: \"" << path << "\" is not a graph snapshot" << endl;
+		return false;
+	}
+	if(header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER){  //checked first: older headers differ in size
+		cerr << "Err: snapshot \"" << path << "\" has version " << header.version
+		     << ", expected " << SNAPSHOT_VERSION << " in native byte order" << endl;
+		return false;
+	}
+	if(header.headerChecksum != Checksum(&header, offsetof(SnapshotHeader, headerChecksum))){
+		cerr << "Err: snapshot \"" << path << "\" has a corrupt header" << endl;
+		return false;
+	}
+	if(header.fileSize != file->Size()){
+		cerr << "Err: snapshot \"" << path << "\" is truncated" << endl;
+		return false;
+	}
+	if(!SectionsFit(header)){
+		cerr << "Err: snapshot \"" << path << "\" has sections outside the file" << endl;
+		return false;
+	}
+	const char *base = file->Data();
+	int lastOffset = ((const int *)(base + header.offsetsPos))[header.nodes];
+	int lastRevOffset = ((const int *)(base + header.revOffsetsPos))[header.nodes];
+	int lastNameOffset = ((const int *)(base + header.nameOffsetsPos))[header.nodes];
+	if(lastOffset != header.edges || lastRevOffset != header.edges || (uint64_t)lastNameOffset != header.nameBytes){
+		cerr << "Err: snapshot \"" << path << "\" has offsets that do not match its size" << endl;
+		return false;
+	}
+	if(verifyPayload){
+		const char *payload = file->Data() + sizeof(header);
+		if(Checksum(payload, file->Size() - sizeof(header)) != header.payloadChecksum){
+			cerr << "Err: snapshot \"" << path << "\" failed its checksum" << endl;
+			return false;
+		}
+		const int nodes = header.nodes, edges = header.edges, maxWeight = header.maxWeight;
+		if(!ValidRows((const int *)(base + header.offsetsPos), (const int *)(base + header.targetsPos),
+		              (const int *)(base + header.weightsPos), nodes, edges, maxWeight, nodes) ||
+		   !ValidRows((const int *)(base + header.revOffsetsPos), (const int *)(base + header.revSourcesPos),
+		              (const int *)(base + header.revWeightsPos), nodes, edges, maxWeight, nodes) ||
+		   !ValidRows((const int *)(base + header.nameOffsetsPos), NULL, NULL, nodes, (int)header.nameBytes, 0, 0)){
+			cerr << "Err: snapshot \"" << path << "\" has offsets, nodes or weights out of range" << endl;
+			return false;
+		}
+	}
+
+	graph.Attach(header.nodes, header.edges, header.maxWeight,
+	             (const int *)(base + header.offsetsPos),
+	             (const int *)(base + header.targetsPos),
+	             (const int *)(base + header.weightsPos),
+	             (const int *)(base + header.revOffsetsPos),
+	             (const int *)(base + header.revSourcesPos),
+	             (const int *)(base + header.revWeightsPos),
+	             (const int *)(base + header.nameOffsetsPos),
+	             base + header.namesPos,
+	             file);
+	return true;
+}
+
+
+#endif
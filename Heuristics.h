@@ -0,0 +1,200 @@
+#ifndef _HEURISTICS_H
+#define _HEURISTICS_H
+
+#include <climits>
+#include <cmath>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+//*****************************************************************************************
+//Heuristic policies for Graph::SearchAStar. Each one provides
+//
+//    void SetTarget(int dest);       called once at the start of every query
+//    int Estimate(int node) const;   lower bound on the distance from node to dest
+//
+//Every heuristic here is consistent, so A* settles each node at most once. A heuristic
+//object remembers its current target, so each thread needs its own; the expensive
+//data (coordinates, landmark tables) is shared by reference.
+//*****************************************************************************************
+
+
+//********************************
+//Zero Heuristic Struct
+//********************************
+//No guidance at all: A* with this heuristic is exactly Dijkstra's algorithm.
+struct ZeroHeuristic{
+	void SetTarget(int){}
+	int Estimate(int) const { return 0; }
+};
+
+
+//********************************
+//Coordinate Heuristic Class Header
+//********************************
+//Straight-line distance to the target divided by the fastest speed seen on any edge.
+//Coordinates are integers in any planar unit (for example meters in a local projection).
+class CoordinateHeuristic{
+	const vector<int> &x;                      //x coordinate of each node
+	const vector<int> &y;                      //y coordinate of each node
+	double perUnit;                            //smallest weight per unit of straight-line distance
+	double tx, ty;                             //coordinates of the current target
+
+public:
+	CoordinateHeuristic(const Graph &g, const vector<int> &xs, const vector<int> &ys);
+	void SetTarget(int dest){ tx = x[dest]; ty = y[dest]; }
+	int Estimate(int node) const{
+		double dx = x[node] - tx, dy = y[node] - ty;
+		return (int)(sqrt(dx * dx + dy * dy) * perUnit);
+	}
+};
+
+
+//*****************************************************************************************
+//Function:     Coordinate Heuristic constructor
+//Purpose:      Calibrate the speed bound from the graph so the estimate is admissible:
+//              every edge covers at most (weight / perUnit) units of straight-line
+//              distance, so no path can reach the target faster than the estimate.
+//Incoming:     g: a frozen graph
+//              xs / ys: one coordinate pair per node (must outlive the heuristic)
+//Outgoing:     A heuristic ready for SetTarget
+//Return:       N/A
+//*****************************************************************************************
+CoordinateHeuristic::CoordinateHeuristic(const Graph &g, const vector<int> &xs, const vector<int> &ys)
+	:x(xs),y(ys),perUnit(0),tx(0),ty(0){
+	const int *offsets = g.Offsets();
+	const int *targets = g.Targets();
+	const int *weights = g.Weights();
+	double best = -1;
+	for(int u = 0; u < g.NumNodes(); u++){
+		for(int e = offsets[u]; e < offsets[u+1]; e++){
+			double dx = x[u] - x[targets[e]], dy = y[u] - y[targets[e]];
+			double length = sqrt(dx * dx + dy * dy);
+			if(length == 0)
+				continue;
+			double ratio = weights[e] / length;
+			if(best < 0 || ratio < best)
+				best = ratio;
+		}
+	}
+	perUnit = best > 0 ? best * (1 - 1e-9) : 0;  //shave off rounding error so we never overestimate
+}
+
+
+//********************************
+//Landmark Table Class Header
+//********************************
+//ALT preprocessing: exact distances from and to a handful of landmark nodes, stored
+//node-major so one query touches a single short row per node. Built once per graph and
+//shared by every LandmarkHeuristic.
+class LandmarkTable{
+	int count;                                 //number of landmarks
+	vector<int> landmarks;                     //the landmark nodes
+	vector<int> table;                         //row v: (from landmark l, to landmark l) for each l
+
+public:
+	LandmarkTable(Graph &g, int landmarkCount, int first = 0);
+	int Count() const { return count; }
+	const vector<int> &Landmarks() const { return landmarks; }
+	const int *Row(int node) const { return table.data() + (size_t)node * 2 * count; }
+};
+
+
+//*****************************************************************************************
+//Function:     Landmark Table constructor
+//Purpose:      Choose landmarks by farthest-point selection (each new landmark is the node
+//              farthest from every landmark so far, which spreads them to the edges of the
+//              network) and record forward and backward distances for each one
+//Incoming:     g: the graph (frozen by this call)
+//              landmarkCount: how many landmarks to place
+//              first: the node to start the selection from
+//Outgoing:     A filled table
+//Return:       N/A
+//*****************************************************************************************
+LandmarkTable::LandmarkTable(Graph &g, int landmarkCount, int first):count(0){
+	g.Freeze();
+	int nodes = g.NumNodes();
+	if(nodes == 0)
+		return;
+	int width = min(landmarkCount, nodes);     //landmarks the table has room for
+	table.assign((size_t)nodes * 2 * width, INT_MAX);
+
+	SearchState from, to;
+	vector<int> nearest(nodes, INT_MAX);       //distance from the closest landmark chosen so far
+	int landmark = first;
+	for(int l = 0; l < width; l++){
+		landmarks.push_back(landmark);
+		g.Search(landmark, NULL, 0, from);
+		g.Search(landmark, NULL, 0, to, true);
+		for(int v = 0; v < nodes; v++){
+			int *row = &table[(size_t)v * 2 * width];
+			row[2*l] = from.Dist(v);
+			row[2*l+1] = to.Dist(v);
+			nearest[v] = min(nearest[v], from.Dist(v));
+		}
+
+		int farthest = -1;                         //nodes no landmark reaches count as farthest of all
+		for(int v = 0; v < nodes; v++){
+			if(nearest[v] > 0 && (farthest < 0 || nearest[v] > nearest[farthest]))
+				farthest = v;
+		}
+		if(farthest < 0)                           //every node is already on top of a landmark
+			break;
+		landmark = farthest;
+	}
+
+	count = (int)landmarks.size();
+	if(count < width){                         //we stopped early: close up the unused columns
+		for(int v = 0; v < nodes; v++)
+			for(int i = 0; i < 2 * count; i++)
+				table[(size_t)v * 2 * count + i] = table[(size_t)v * 2 * width + i];
+		table.resize((size_t)nodes * 2 * count);
+	}
+}
+
+
+//********************************
+//Landmark Heuristic Class Header
+//********************************
+//ALT lower bound from the triangle inequality. For every landmark L:
+//    d(v, t) >= d(L, t) - d(L, v)     and     d(v, t) >= d(v, L) - d(t, L)
+//and the estimate is the largest of these bounds.
+class LandmarkHeuristic{
+	const LandmarkTable &table;                //shared preprocessing
+	vector<int> target;                        //copy of the current target's row
+
+public:
+	LandmarkHeuristic(const LandmarkTable &t):table(t),target(2 * t.Count()){};
+	void SetTarget(int dest){
+		const int *row = table.Row(dest);
+		for(size_t i = 0; i < target.size(); i++)
+			target[i] = row[i];
+	}
+	int Estimate(int node) const;
+};
+
+
+//*****************************************************************************************
+//Function:     Estimate
+//Purpose:      Lower bound on the distance from node to the current target. Bounds that
+//              involve a node a landmark cannot reach (or be reached from) are skipped.
+//Incoming:     node: the node to estimate from
+//Outgoing:     N/A
+//Return:       The largest landmark bound, or 0
+//*****************************************************************************************
+int LandmarkHeuristic::Estimate(int node) const{
+	const int *row = table.Row(node);
+	int best = 0;
+	for(int l = 0; l < table.Count(); l++){
+		int fromV = row[2*l], toV = row[2*l+1];
+		int fromT = target[2*l], toT = target[2*l+1];
+		if(fromT != INT_MAX && fromV != INT_MAX && fromT - fromV > best)
+			best = fromT - fromV;
+		if(toV != INT_MAX && toT != INT_MAX && toV - toT > best)
+			best = toV - toT;
+	}
+	return best;
+}
+
+
+#endif
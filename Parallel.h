@@ -0,0 +1,86 @@
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+using namespace std;
+
+//*****************************************************************************************
+//Function:     Thread Count
+//Purpose:      Turn a requested thread count into a usable one
+//Incoming:     threads: requested count (0 or less means one per hardware thread)
+//Outgoing:     N/A
+//Return:       The number of threads to use (at least 1)
+//*****************************************************************************************
+inline int ThreadCount(int threads){
+	if(threads > 0)
+		return threads;
+	return max(1, (int)thread::hardware_concurrency());
+}
+
+
+//*****************************************************************************************
+//Function:     Parallel For
+//Purpose:      Run body(i, worker) for every i in [0, count) across "threads" workers.
+//              Items are handed out in small chunks through an atomic counter, so uneven
+//              items balance themselves. The calling thread is worker 0.
+//Incoming:     count: number of items
+//              threads: number of workers (see ThreadCount)
+//              body: callable taking (int item, int worker)
+//Outgoing:     Every item has been processed when this returns
+//Return:       N/A-void function
+//*****************************************************************************************
+template<class Body>
+void ParallelFor(int count, int threads, Body body){
+	threads = min(ThreadCount(threads), max(count, 1));
+	const int chunk = max(1, min(64, count / (threads * 8)));
+	atomic<int> next(0);
+	auto work = [&](int worker){
+		while(true){
+			int first = next.fetch_add(chunk);
+			if(first >= count)
+				return;
+			int last = min(count, first + chunk);
+			for(int i = first; i < last; i++)
+				body(i, worker);
+		}
+	};
+
+	vector<thread> helpers;
+	for(int t = 1; t < threads; t++)
+		helpers.push_back(thread(work, t));
+	work(0);
+	for(size_t t = 0; t < helpers.size(); t++)
+		helpers[t].join();
+}
+
+
+//********************************
+//Barrier Class Header
+//********************************
+//Reusable barrier for a fixed team of threads that meet many times in quick succession.
+//Waiting threads yield instead of sleeping on a condition variable, so each meeting costs
+//microseconds rather than a round trip through the scheduler.
+class Barrier{
+	const int count;                           //threads in the team
+	atomic<int> arrived;                       //threads at the current meeting
+	atomic<unsigned> phase;                    //number of meetings completed
+
+public:
+	explicit Barrier(int threads):count(threads),arrived(0),phase(0){};
+	void Wait(){
+		unsigned current = phase.load();
+		if(arrived.fetch_add(1) + 1 == count){     //last one in releases everybody
+			arrived.store(0);
+			phase.fetch_add(1);
+		} else {
+			while(phase.load() == current)
+				this_thread::yield();
+		}
+	}
+};
+
+
+#endif
@@ -5,19 +5,27 @@
 #include <vector>
 #include <algorithm>
 #include <limits>
+#include <climits>
 using namespace std;
 
 //********************************
 //Priority Queue class header
 //********************************
-class PriorityQueue{
+//Indexed d-ary min-heap. Every node index that is currently in the heap has its
+//heap slot recorded in "position", so checking for and decreasing an existing node
+//is O(1) + O(log_d n) instead of a linear scan. ARITY is the fan-out of the tree:
+//2 is a classic binary heap, 4 and 8 keep all children of a slot in one cache line.
+template<int ARITY>
+class IndexedPriorityQueue{
+	static_assert(ARITY >= 2, "a heap needs at least two children per node");
+
 	//********************************
 	//PQNode struct implementation
 	//********************************
 	struct PQNode{
 		int index;		//index of the current node
 		int distance;	//distance it is from the source
-		
+
 
 		PQNode():index(0), distance(0){};
 		PQNode(int curr, int dist):index(curr), distance(dist){};
@@ -27,106 +35,152 @@ class PriorityQueue{
 //Priority Queue Private Data Members and Functions
 //**************************************************
 	vector<PQNode> queue;		                                        //queue represented as a vector
-	
-	int Parent(int i){ return (i-1)/2;}                                 //get index of parent
-    int Left(int i){ return (2*i + 1);}                                 //get index of left child
-    int Right(int i){ return (2*i + 2);}                                //get index of right child
-    
-    bool HasLeft(int i){ return (Left(i) < (int)queue.size()); }        //is there a left child?
-    bool HasRight(int i){ return (Right(i) < (int)queue.size()); }      //is there a right child?
-    
-    int PercolateDown(int hole);                                        //percolate the "hole" down
-    int PercolateUp(int index);                                         //percolate a node up
-    
+	vector<int> position;                                               //node index -> slot in queue (-1 if not queued)
+
+	int Parent(int i){ return (i-1)/ARITY;}                             //get index of parent
+    int FirstChild(int i){ return (ARITY*i + 1);}                       //get index of the leftmost child
+
+    int PercolateDown(int hole, int dist);                              //percolate the "hole" down
+    int PercolateUp(int hole, int dist);                                //percolate the "hole" up
+    void Place(int slot, const PQNode &node);                           //store a node in a slot and record its position
+
     void DecreaseDist(int index, int dist);                             //decrease the distance of a node
 	bool CheckIndex(int index);                                         //does the index exist in the queue
 
 //********************************
 //Priority Queue Public Functions
-//******************************** 
+//********************************
 public:
-    PriorityQueue();
-	void Enqueue(int index, int dist);                                   //enqueue (insert)
+    IndexedPriorityQueue();
+    IndexedPriorityQueue(int capacity);
+    void Reserve(int capacity);                                         //pre-size for node indices [0, capacity)
+	void Enqueue(int index, int dist);                                  //enqueue (insert or decrease)
 	int Dequeue(int &distance);                                         //dequeue (remove min)
+	bool Empty() const { return queue.empty(); }                        //is the queue empty?
+	int Size() const { return (int)queue.size(); }                      //number of queued nodes
+	int TopDistance() const { return queue.empty() ? INT_MAX : queue[0].distance; } //smallest queued distance
+	bool Contains(int index) const { return index < (int)position.size() && position[index] >= 0; } //is the node queued?
+	void Clear();                                                       //empty the queue, keeping its memory
 };
 
-PriorityQueue::PriorityQueue(){
-	
+typedef IndexedPriorityQueue<4> PriorityQueue;                          //default fan-out used by the graph searches
+
+
+template<int ARITY>
+IndexedPriorityQueue<ARITY>::IndexedPriorityQueue(){
+
+}
+
+template<int ARITY>
+IndexedPriorityQueue<ARITY>::IndexedPriorityQueue(int capacity){
+	Reserve(capacity);
+}
+
+
+//*****************************************************************************************
+//Function:     Reserve
+//Purpose:      Pre-size the position map and the heap so that node indices below
+//              "capacity" never cause a reallocation while searching
+//Incoming:     capacity: one past the largest node index that will be enqueued
+//Outgoing:     Position map and heap storage grown to fit
+//Return:       N/A-void function
+//*****************************************************************************************
+template<int ARITY>
+void IndexedPriorityQueue<ARITY>::Reserve(int capacity){
+	if(capacity > (int)position.size())
+		position.resize(capacity, -1);
+	queue.reserve(capacity);
+}
+
+
+//*****************************************************************************************
+//Function:     Place
+//Purpose:      Write a node into a heap slot and keep the position map in sync
+//Incoming:     slot: the heap slot to fill
+//              node: the node to store there
+//Outgoing:     Updated queue and position map
+//Return:       N/A-void function
+//*****************************************************************************************
+template<int ARITY>
+void IndexedPriorityQueue<ARITY>::Place(int slot, const PQNode &node){
+	queue[slot] = node;
+	position[node.index] = slot;
 }
 
 
 //*****************************************************************************************
 //Function:     Percolate Down
-//Purpose:      Move the "hole" down the list to prep for Dequeue
+//Purpose:      Move the "hole" down the tree until a node with distance "dist" fits there.
+//              Children are moved up into the hole instead of being swapped, so each
+//              level costs one write.
 //Incoming:     hole: index of the hole
+//              dist: distance of the node that will fill the hole
 //Outgoing:     Updated tree with hole moved down
 //Return:       The new index of where the hole now is
 //Author:       Jalyn Cosby, Whittney Schwarz
 //Modified by:  Joshua Brown
 //*****************************************************************************************
-int PriorityQueue::PercolateDown(int hole){
-    while (HasLeft(hole) || HasRight(hole)){                                    //continue looping while the hole still has any children
-    
-    	if(HasLeft(hole) && HasRight(hole)){                                        //If there are two children,
-    		if(queue[Left(hole)].distance <= queue[Right(hole)].distance){              //and if the left child is smaller than the right child,
-    			if(queue[queue.size()-1].distance >= queue[Left(hole)].distance){           //and only if the last node in the tree can fit where the child is,
-                    iter_swap(queue.begin() + hole, queue.begin() + Left(hole));                //then swap the hole node with the child node
-                    hole = Left(hole);                                                          //and update the index value for the hole.
-                } else                                                                      //If the last node can't fit where the child is,
-                    break;                                                                      //then we've already found a sutiable postion for it and we can break the loop.
-                
-            } else {                                                                    //If the right child is smaller than the left child,
-                if(queue[queue.size()-1].distance >= queue[Right(hole)].distance){          //and only if the last node in the tree can fit where the child is,
-                    iter_swap(queue.begin() + hole, queue.begin() + Right(hole));               //then swap the hole node with the child node
-                    hole = Right(hole);                                                         //and update the index value for the hole.
-                } else                                                                      //If the last node can't fit where the child is,
-                    break;                                                                      //then we've already found a sutiable postion for it and we can break the loop.
-            }
-        } else {                                                                    //If there is only a left child,
-            if(queue[queue.size()-1].distance >= queue[Left(hole)].distance){           //and only if the last node in the tree can fit where the child is,
-                iter_swap(queue.begin() + hole, queue.begin() + Left(hole));                //then swap the hole node with the child node
-                hole = Left(hole);                                                          //and update the index value for the hole.
-            } else                                                                      //If the last node can't fit where the child is,
-                break;                                                                      //then we've already found a sutiable postion for it and we can break the loop.
-        }
+template<int ARITY>
+int IndexedPriorityQueue<ARITY>::PercolateDown(int hole, int dist){
+	int size = (int)queue.size();
+    while(true){
+    	int first = FirstChild(hole);
+    	if(first >= size)                                                           //no children, the hole is a leaf
+    		break;
+
+    	int last = min(first + ARITY, size);
+    	int best = first;                                                           //find the smallest of up to ARITY children
+    	for(int c = first + 1; c < last; c++){
+    		if(queue[c].distance < queue[best].distance)
+    			best = c;
+    	}
+
+    	if(queue[best].distance >= dist)                                            //if the node fits above its smallest child,
+    		break;                                                                      //then we've found a suitable position for it
+
+    	Place(hole, queue[best]);                                                   //otherwise move the child up into the hole
+    	hole = best;                                                                //and continue from the child's old slot
     }
-    return hole;                                                                //return the index of where the hole now is, so it can be filled in the Dequeue function
+    return hole;                                                                //return the index of where the hole now is, so it can be filled by the caller
 }
 
 
 //*****************************************************************************************
 //Function:     Percolate Up
-//Purpose:      Move a node up the tree to fix the heap-order property
-//Incoming:     index: index of the node to be percolated
-//Outgoing:     Updated tree with the node moved up
+//Purpose:      Move the "hole" up the tree to fix the heap-order property
+//Incoming:     hole: index of the hole
+//              dist: distance of the node that will fill the hole
+//Outgoing:     Updated tree with the hole moved up
 //Return:       Updated index of where the hole is
 //Author:       Joshua Brown, Tay Cavett, Jalyn Cosby, Whittney Schwarz
 //Source:		https://www.geeksforgeeks.org/binary-heap/
 //*****************************************************************************************
-int PriorityQueue::PercolateUp(int index){
-    while(index >= 0 && queue[Parent(index)].distance > queue[index].distance){ //loop until we've either reached the top, or found a suitable postion for the node
-		iter_swap(queue.begin() + index, queue.begin() + Parent(index));            //continue swapping the current node with its parent
-		index = Parent(index);                                                      //update the index of the new current node
+template<int ARITY>
+int IndexedPriorityQueue<ARITY>::PercolateUp(int hole, int dist){
+    while(hole > 0 && queue[Parent(hole)].distance > dist){                     //loop until we've either reached the top, or found a suitable postion for the node
+		Place(hole, queue[Parent(hole)]);                                           //move the parent down into the hole
+		hole = Parent(hole);                                                        //update the index of the hole
 	}
-	return index;                                                               //return the index of where the node now is
+	return hole;                                                                //return the index of where the hole now is
 }
 
 
 //**********************************************************************************
 //Function:     Decrease Distance
-//Purpose:      Update a certain node's distance value, then fix the heap-order property
-//Incoming:     index: the index of the node to be changed
+//Purpose:      Update a queued node's distance value, then fix the heap-order property.
+//              Distances that are not smaller than the queued one are ignored.
+//Incoming:     index: the node index (not the heap slot) of the node to be changed
 //              dist: the NEW integer distance of the node from the source
 //Outgoing:     Updated tree with the new value changed
 //Return:       N/A-void function
 //Author:       Joshua Brown, Jalyn Cosby
 //**********************************************************************************
-void PriorityQueue::DecreaseDist(int index, int dist){
-    if(index >= 0 && index < (int)queue.size()){    //only if the index is a valid node in the vector
-        queue[index].distance = dist;                   //update the distance at that node
-        PercolateUp(index);                             //percolate up the updated node to ensure heap-order property is maintained
-    } else                                          //otherwise, error
-        cout << "Err: \"" << index << "\" is not a valid index" << endl;
+template<int ARITY>
+void IndexedPriorityQueue<ARITY>::DecreaseDist(int index, int dist){
+	int slot = position[index];                     //look up where the node lives in the heap
+	if(dist >= queue[slot].distance)                //only a strictly smaller distance can move it
+		return;
+	Place(PercolateUp(slot, dist), PQNode(index, dist));
 }
 
 
@@ -138,15 +192,9 @@ void PriorityQueue::DecreaseDist(int index, int dist){
 //Return:       If we found the index or not
 //Author:       Joshua Brown, Tay Cavett, Jalyn Cosby, Whittney Schwarz
 //**********************************************************************************
-bool PriorityQueue::CheckIndex(int index){
-	bool retval = false;                       //default to false unless we find the index in the queue
-	for(int i = 0; i < queue.size(); i++){     //loop through the entire queue
-		if(queue[i].index == index){               //if the current node's index is equal to the one we're searching for
-			retval = true;                             //then set the return value to true
-			break;                                     //break the loop so as to not waste more time
-		}
-	}
-	return retval;                             //return whether or not we found the index in the queue
+template<int ARITY>
+bool IndexedPriorityQueue<ARITY>::CheckIndex(int index){
+	return index < (int)position.size() && position[index] >= 0;
 }
 
 
@@ -161,15 +209,16 @@ bool PriorityQueue::CheckIndex(int index){
 //Return:       N/A-void function
 //Author:       Joshua Brown, Tay Cavett, Jalyn Cosby, Whittney Schwarz
 //*****************************************************************************************
-void PriorityQueue::Enqueue(int index, int dist){
+template<int ARITY>
+void IndexedPriorityQueue<ARITY>::Enqueue(int index, int dist){
     if(CheckIndex(index))               //if the index already exists within the queue,
         DecreaseDist(index, dist);          //then we update the distance corresponding to that index
     else{                               //otherwise, we enque a new node containing the data
-        PQNode temp(index, dist);          //create a node containing the data
-        
-    	queue.push_back(temp);             //push that node to the back of the queue
-    	
-    	PercolateUp(queue.size()-1);       //percolate up the new node to ensure heap-order property is maintained
+    	if(index >= (int)position.size())  //grow the position map if this index has never been seen
+    		position.resize(max(index + 1, 2 * (int)position.size()), -1);
+
+    	queue.push_back(PQNode(index, dist));                                //open a hole at the back of the queue
+    	Place(PercolateUp(queue.size()-1, dist), PQNode(index, dist));       //percolate the hole up and fill it to maintain heap-order
     }
 }
 
@@ -183,28 +232,41 @@ void PriorityQueue::Enqueue(int index, int dist){
 //Author:       Jalyn Cosby, Whittney Schwarz
 //Modified by:	Joshua Brown
 //**********************************************************************************
-int PriorityQueue::Dequeue(int &distance){
+template<int ARITY>
+int IndexedPriorityQueue<ARITY>::Dequeue(int &distance){
 	int retval = INT_MIN;                    //initially set the return value to INT_MIN, in case we are unable to dequeue
-	int hole = 0;                            //the "hole" will always be the root (first item in vector)
-	
+
 	if (queue.size() > 0){                   //Only if we have items in the queue, are we able to dequeue anything.
-        
+
         retval = queue[0].index;                 //set the return value to the index of the current node
         distance = queue[0].distance;            //set the parameter for the distance of the current node (to be passed back by reference)
-        
-        if(queue.size() == 1)                    //If there is only one item in the queue,
-            queue.pop_back();                        //we only need to remove that one item, no need to percolate.
-        else{                                    //Otherwise,
-            hole = PercolateDown(hole);                             //we need to percolate the hole down
-    		queue[hole].index = queue[queue.size()-1].index;        //then fill the hole with the index data copied from the last node in the vector
-    		queue[hole].distance = queue[queue.size()-1].distance;  //and copy the distance data as well
-    		queue.pop_back();                                       //then simply remove the last node from the vector now that we've copied all its data
-        }
+        position[retval] = -1;                   //the node is no longer queued
+
+        PQNode last = queue.back();              //the last node will fill the hole left at the root
+        queue.pop_back();
+        if(!queue.empty())                       //If anything is left, percolate the hole down and drop the last node into it
+            Place(PercolateDown(0, last.distance), last);
 	}
 	return retval;                           //return the index (passing back distance by reference)
 }
 
 
+//**********************************************************************************
+//Function:     Clear
+//Purpose:      Remove every node from the queue. Only the slots that are still
+//              queued are touched, so the cost is proportional to the queue size.
+//Incoming:     N/A
+//Outgoing:     Empty queue; the heap and position map keep their capacity
+//Return:       N/A-void function
+//**********************************************************************************
+template<int ARITY>
+void IndexedPriorityQueue<ARITY>::Clear(){
+	for(int i = 0; i < (int)queue.size(); i++)
+		position[queue[i].index] = -1;
+	queue.clear();
+}
+
+
 
 
-#endif	
+#endif
@@ -0,0 +1,305 @@
+#ifndef _QUERYCACHE_H
+#define _QUERYCACHE_H
+
+#include <climits>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+//********************************
+//Cache Stats Struct
+//********************************
+struct CacheStats{
+	unsigned long long pathHits;               //queries answered from a cached path
+	unsigned long long treeHits;               //queries answered from a cached source tree
+	unsigned long long misses;                 //queries that needed a search
+	unsigned long long invalidations;          //times a graph change emptied the cache
+
+	CacheStats():pathHits(0),treeHits(0),misses(0),invalidations(0){};
+	unsigned long long Lookups() const { return pathHits + treeHits + misses; }
+	double HitRate() const { return Lookups() ? (double)(pathHits + treeHits) / Lookups() : 0.0; }
+};
+
+
+//********************************
+//Query Cache Class Header
+//********************************
+//Remembers answered queries so that a repeated (src, dest) pair costs a hash lookup
+//instead of a search. Two bounded LRU lists are kept: finished paths keyed by
+//(src, dest), and full shortest-path trees for sources that keep missing, since one
+//tree answers every destination from that source. Every entry belongs to one graph
+//version; the first lookup after the graph changes (AddNode or Resize, Freeze packing
+//new edges, UpdateWeight, RemoveEdge) empties the cache. Lookups from several threads
+//may run at once, each with its own SearchState, but the graph itself must not change
+//while any of them is running.
+class QueryCache{
+	//********************************
+	//Entry Structs Implementation
+	//********************************
+	struct PathEntry{
+		unsigned long long key;                    //(src, dest) packed by Key()
+		PathResult result;                         //the answer
+	};
+	struct TreeEntry{
+		int src;                                   //root of the tree
+		vector<int> dist;                          //distance of every node (INT_MAX if unreachable)
+		vector<int> parent;                        //tree predecessor of every node
+	};
+	typedef list<PathEntry>::iterator PathSlot;
+	typedef list<TreeEntry>::iterator TreeSlot;
+
+//**************************************************
+//Query Cache Private Data Members and Functions
+//**************************************************
+	const Graph &graph;                        //the graph being queried (frozen)
+	size_t pathCapacity;                       //most paths kept
+	size_t treeCapacity;                       //most source trees kept
+	int hotThreshold;                          //misses from one source before its tree is cached
+
+	mutable mutex lock;                        //guards everything below
+	unsigned long long version;                //graph version the entries belong to
+	list<PathEntry> paths;                     //cached paths, most recently used first
+	unordered_map<unsigned long long, PathSlot> pathIndex;
+	list<TreeEntry> trees;                     //cached trees, most recently used first
+	unordered_map<int, TreeSlot> treeIndex;
+	vector<int> sourceMisses;                  //misses per source since its last tree, to spot hot ones
+	CacheStats stats;
+
+	static unsigned long long Key(int src, int dest){ return ((unsigned long long)(unsigned)src << 32) | (unsigned)dest; }
+	void Validate();                           //empty the cache if the graph has changed
+	void StorePath(int src, int dest, const PathResult &result);
+	void StoreTree(int src, const SearchState &state);
+	void TreePath(const TreeEntry &tree, int dest, PathResult &result) const;
+
+//********************************
+//Query Cache Public Functions
+//********************************
+public:
+	QueryCache(Graph &g, int maxPaths = 4096, int maxTrees = 8, int hotSource = 4);
+	QueryCache(const QueryCache &) = delete;
+	QueryCache &operator=(const QueryCache &) = delete;
+	bool FindPath(int src, int dest, SearchState &state, PathResult &result); //answer a query, from the cache if possible
+	void Clear();                              //forget every entry (the counters are kept)
+	CacheStats Stats() const;                  //hit and miss counts so far
+	int Paths() const;                         //number of cached paths
+	int Trees() const;                         //number of cached source trees
+};
+
+
+//*****************************************************************************************
+//Function:     Query Cache constructor
+//Purpose:      Freeze the graph and start with an empty cache
+//Incoming:     g: the graph to answer queries on
+//              maxPaths: how many (src, dest) answers to keep
+//              maxTrees: how many full source trees to keep (0 turns them off); each
+//                        costs two ints per node
+//              hotSource: how many misses from one source make it worth a full tree
+//Outgoing:     An empty cache
+//Return:       N/A
+//*****************************************************************************************
+QueryCache::QueryCache(Graph &g, int maxPaths, int maxTrees, int hotSource)
+	:graph(g),pathCapacity(max(maxPaths, 0)),treeCapacity(max(maxTrees, 0)),hotThreshold(max(hotSource, 1)),version(0){
+	g.Freeze();
+	version = g.Version();
+	sourceMisses.assign(g.NumNodes(), 0);
+	pathIndex.reserve(pathCapacity);           //sized up front so a full cache never rehashes
+	treeIndex.reserve(treeCapacity);
+}
+
+
+//*****************************************************************************************
+//Function:     Find Path
+//Purpose:      Answer a query from a cached path or source tree when there is one.
+//              Otherwise search outside the lock and remember the answer: normally just
+//              the path, but a source that has missed hotSource times gets a full
+//              one-to-all search and its whole tree is cached instead.
+//Incoming:     src / dest: the query
+//              state: the calling thread's scratch state, used on a miss
+//              result: receives the cost and the path
+//Outgoing:     result is filled in
+//Return:       Whether dest is reachable from src
+//*****************************************************************************************
+bool QueryCache::FindPath(int src, int dest, SearchState &state, PathResult &result){
+	bool wholeTree = false;
+	{
+		lock_guard<mutex> guard(lock);
+		Validate();
+		unordered_map<unsigned long long, PathSlot>::iterator hit = pathIndex.find(Key(src, dest));
+		if(hit != pathIndex.end()){
+			paths.splice(paths.begin(), paths, hit->second);   //now the most recently used
+			result = hit->second->result;
+			stats.pathHits++;
+			return result.Found();
+		}
+		unordered_map<int, TreeSlot>::iterator tree = treeIndex.find(src);
+		if(tree != treeIndex.end()){
+			trees.splice(trees.begin(), trees, tree->second);
+			TreePath(*tree->second, dest, result);
+			stats.treeHits++;
+			return result.Found();
+		}
+		stats.misses++;
+		if(treeCapacity > 0 && ++sourceMisses[src] >= hotThreshold){
+			sourceMisses[src] = 0;
+			wholeTree = true;
+		}
+	}
+
+	if(wholeTree)
+		graph.Search(src, NULL, 0, state);
+	else
+		graph.Search(src, &dest, 1, state);
+	graph.BuildPath(src, dest, state, result);
+
+	lock_guard<mutex> guard(lock);
+	Validate();
+	if(wholeTree)
+		StoreTree(src, state);
+	else
+		StorePath(src, dest, result);
+	return result.Found();
+}
+
+
+//*****************************************************************************************
+//Function:     Validate
+//Purpose:      Empty the cache if the graph's version has moved on since the entries
+//              were made. The lock must be held.
+//Incoming:     N/A
+//Outgoing:     Every entry belongs to the current graph version
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryCache::Validate(){
+	if(graph.Version() == version)
+		return;
+	version = graph.Version();
+	paths.clear();
+	pathIndex.clear();
+	trees.clear();
+	treeIndex.clear();
+	sourceMisses.assign(graph.NumNodes(), 0);
+	stats.invalidations++;
+}
+
+
+//*****************************************************************************************
+//Function:     Store Path / Store Tree
+//Purpose:      Add an answer at the front of its LRU list, evicting the least recently
+//              used entry when the list is full. The evicted entry's list node, index
+//              node and arrays are reused, so a full cache stores without allocating.
+//              The lock must be held.
+//Incoming:     src / dest: the query (StorePath only)
+//              result: the answer (StorePath only)
+//              state: a finished one-to-all search from src (StoreTree only)
+//Outgoing:     The entry is cached
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryCache::StorePath(int src, int dest, const PathResult &result){
+	if(pathCapacity == 0)
+		return;
+	unsigned long long key = Key(src, dest);
+	if(pathIndex.count(key))                   //another thread got here first
+		return;
+	if(paths.size() >= pathCapacity){
+		paths.splice(paths.begin(), paths, prev(paths.end()));   //recycle the oldest entry
+		auto node = pathIndex.extract(paths.front().key);
+		node.key() = key;
+		node.mapped() = paths.begin();
+		pathIndex.insert(move(node));
+	} else{
+		paths.push_front(PathEntry());
+		pathIndex[key] = paths.begin();
+	}
+	paths.front().key = key;
+	paths.front().result = result;
+}
+
+void QueryCache::StoreTree(int src, const SearchState &state){
+	if(treeIndex.count(src))
+		return;
+	if(trees.size() >= treeCapacity){
+		trees.splice(trees.begin(), trees, prev(trees.end()));
+		auto node = treeIndex.extract(trees.front().src);
+		node.key() = src;
+		node.mapped() = trees.begin();
+		treeIndex.insert(move(node));
+	} else{
+		trees.push_front(TreeEntry());
+		treeIndex[src] = trees.begin();
+	}
+	TreeEntry &tree = trees.front();
+	int nodes = graph.NumNodes();
+	tree.src = src;
+	tree.dist.resize(nodes);
+	tree.parent.resize(nodes);
+	for(int i = 0; i < nodes; i++){
+		tree.dist[i] = state.Dist(i);
+		tree.parent[i] = state.ChangedBy(i);
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Tree Path
+//Purpose:      Read the path to dest out of a cached tree, the same way BuildPath reads
+//              it out of a search
+//Incoming:     tree: a cached source tree
+//              dest: the destination node
+//              result: receives the cost and the path
+//Outgoing:     result is filled in
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryCache::TreePath(const TreeEntry &tree, int dest, PathResult &result) const{
+	result.cost = tree.dist[dest];
+	if(result.cost == INT_MAX){
+		result.path.clear();
+		return;
+	}
+	int hops = 0;
+	for(int location = dest; location != tree.src; location = tree.parent[location])
+		hops++;
+	result.path.resize(hops + 1);
+	int location = dest;
+	for(int i = hops; i >= 0; i--){
+		result.path[i] = location;
+		location = tree.parent[location];
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Clear / Stats / Paths / Trees
+//Purpose:      Forget every entry, or report on the cache
+//Incoming:     N/A
+//Outgoing:     N/A
+//Return:       The counters, or the number of cached paths / trees
+//*****************************************************************************************
+void QueryCache::Clear(){
+	lock_guard<mutex> guard(lock);
+	paths.clear();
+	pathIndex.clear();
+	trees.clear();
+	treeIndex.clear();
+	sourceMisses.assign(graph.NumNodes(), 0);
+}
+
+CacheStats QueryCache::Stats() const{
+	lock_guard<mutex> guard(lock);
+	return stats;
+}
+
+int QueryCache::Paths() const{
+	lock_guard<mutex> guard(lock);
+	return (int)paths.size();
+}
+
+int QueryCache::Trees() const{
+	lock_guard<mutex> guard(lock);
+	return (int)trees.size();
+}
+
+
+#endif
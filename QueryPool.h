@@ -0,0 +1,218 @@
+#ifndef _QUERYPOOL_H
+#define _QUERYPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+//********************************
+//Query Struct Implementation
+//********************************
+struct Query{
+	int src;           //starting node
+	int dest;          //destination node
+
+	Query():src(0),dest(0){};
+	Query(int source, int destination):src(source),dest(destination){};
+};
+
+
+//********************************
+//Query Pool Class Header
+//********************************
+//A fixed set of worker threads that answer batches of (src, dest) queries against one
+//frozen graph. Queries that share a source are answered by a single search, and every
+//worker keeps its own SearchState, so a batch allocates nothing once the pool is warm.
+class QueryPool{
+	Graph &graph;                              //the graph every worker searches
+	vector<thread> workers;                    //the worker threads
+	vector<SearchState> states;                //one reusable scratch state per worker
+
+	mutex lock;                                //guards everything below
+	condition_variable wake;                   //signalled when a batch is posted
+	condition_variable done;                   //signalled when the last worker finishes
+	int job;                                   //number of batches posted so far
+	int finished;                              //workers done with the current batch
+	bool stopping;                             //set when the pool is being destroyed
+
+	vector<int> order;                         //query indices sorted by source
+	vector<int> dests;                         //destination of each query, in "order"
+	vector<int> groups;                        //start of each same-source run in "order" (plus an end marker)
+	vector<int> sources;                       //source of each group
+	vector<int> *costs;                        //where the current batch writes its costs (or NULL)
+	vector<PathResult> *paths;                 //where the current batch writes its paths (or NULL)
+	atomic<int> nextGroup;                     //next group a worker should take
+	SearchTracer *tracer;                      //where each group's search stats are offered (or NULL)
+
+	void WorkerLoop(int id);                   //body of each worker thread
+	void RunGroup(int group, SearchState &state); //answer every query in one group
+	void Post(const vector<Query> &queries);   //group a batch and wait for the workers to answer it
+
+public:
+	QueryPool(Graph &g, int threads = 0);      //0 threads means one per core
+	~QueryPool();
+	QueryPool(const QueryPool &) = delete;
+	QueryPool &operator=(const QueryPool &) = delete;
+	int Threads() const { return (int)workers.size(); }
+	void SetTracer(SearchTracer *t){ tracer = t; } //sample search stats into t (NULL to stop); not during a Run
+	void Run(const vector<Query> &queries, vector<int> &answers); //answer a batch (INT_MAX = unreachable)
+	void Run(const vector<Query> &queries, vector<PathResult> &answers); //answer a batch with full paths
+};
+
+
+//*****************************************************************************************
+//Function:     Query Pool constructor
+//Purpose:      Freeze the graph and start the worker threads
+//Incoming:     g: the graph to answer queries on; it must not change while the pool runs
+//              threads: number of workers (0 for one per hardware thread)
+//Outgoing:     A pool of idle workers
+//Return:       N/A
+//*****************************************************************************************
+QueryPool::QueryPool(Graph &g, int threads):graph(g),job(0),finished(0),stopping(false),costs(NULL),paths(NULL),nextGroup(0),tracer(NULL){
+	graph.Freeze();
+	if(threads <= 0)
+		threads = max(1u, thread::hardware_concurrency());
+	states.resize(threads);
+	for(int i = 0; i < threads; i++)
+		workers.push_back(thread(&QueryPool::WorkerLoop, this, i));
+}
+
+
+//*****************************************************************************************
+//Function:     Query Pool destructor
+//Purpose:      Stop and join every worker
+//Incoming:     N/A
+//Outgoing:     N/A
+//Return:       N/A
+//*****************************************************************************************
+QueryPool::~QueryPool(){
+	{
+		lock_guard<mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for(size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+
+//*****************************************************************************************
+//Function:     Worker Loop
+//Purpose:      Wait for a batch, take groups from it until none are left, report back
+//Incoming:     id: which worker (and scratch state) this is
+//Outgoing:     N/A
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryPool::WorkerLoop(int id){
+	int seen = 0;                              //last batch this worker took part in
+	while(true){
+		{
+			unique_lock<mutex> guard(lock);
+			wake.wait(guard, [&]{ return stopping || job != seen; });
+			if(stopping)
+				return;
+			seen = job;
+		}
+
+		int groupCount = (int)groups.size() - 1;
+		for(int group = nextGroup++; group < groupCount; group = nextGroup++)
+			RunGroup(group, states[id]);
+
+		lock_guard<mutex> guard(lock);
+		if(++finished == (int)workers.size())
+			done.notify_one();
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Run Group
+//Purpose:      Answer every query that shares one source with a single search
+//Incoming:     group: index into "groups"
+//              state: the worker's scratch state
+//Outgoing:     The group's answers are written to "costs" or "paths"
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryPool::RunGroup(int group, SearchState &state){
+	int first = groups[group];
+	int last = groups[group+1];
+	graph.Search(sources[group], &dests[first], last - first, state);
+	if(tracer)
+		tracer->Record(sources[group], last - first == 1 ? dests[first] : -1, state.stats);
+	for(int k = first; k < last; k++){
+		if(costs)
+			(*costs)[order[k]] = state.Dist(dests[k]);
+		else
+			graph.BuildPath(sources[group], dests[k], state, (*paths)[order[k]]);
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Run
+//Purpose:      Answer a batch of queries across the pool and wait for the answers
+//Incoming:     queries: the (src, dest) pairs to answer
+//              answers: resized to one answer per query, either a travel cost
+//                       (INT_MAX if unreachable) or a full PathResult
+//Outgoing:     answers[i] holds the answer to queries[i]
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryPool::Run(const vector<Query> &queries, vector<int> &answers){
+	answers.resize(queries.size());
+	costs = &answers;
+	Post(queries);
+	costs = NULL;
+}
+
+void QueryPool::Run(const vector<Query> &queries, vector<PathResult> &answers){
+	answers.resize(queries.size());
+	paths = &answers;
+	Post(queries);
+	paths = NULL;
+}
+
+
+//*****************************************************************************************
+//Function:     Post
+//Purpose:      Group a batch by source, wake the workers and wait until every group
+//              has been answered
+//Incoming:     queries: the (src, dest) pairs to answer
+//Outgoing:     The answers are written through "costs" or "paths"
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryPool::Post(const vector<Query> &queries){
+	int count = (int)queries.size();
+
+	order.resize(count);                       //group the queries by source
+	for(int i = 0; i < count; i++)
+		order[i] = i;
+	sort(order.begin(), order.end(), [&](int a, int b){ return queries[a].src < queries[b].src; });
+
+	dests.resize(count);
+	groups.clear();
+	sources.clear();
+	for(int k = 0; k < count; k++){
+		const Query &q = queries[order[k]];
+		dests[k] = q.dest;
+		if(k == 0 || q.src != sources.back()){   //a new source starts a new group
+			groups.push_back(k);
+			sources.push_back(q.src);
+		}
+	}
+	groups.push_back(count);
+
+	unique_lock<mutex> guard(lock);            //post the batch and wait for every worker
+	nextGroup = 0;
+	finished = 0;
+	job++;
+	wake.notify_all();
+	done.wait(guard, [&]{ return finished == (int)workers.size(); });
+}
+
+
+#endif
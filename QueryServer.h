@@ -0,0 +1,538 @@
+#ifndef _QUERYSERVER_H
+#define _QUERYSERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Graph.h"
+#include "QueryPool.h"
+using namespace std;
+
+//*****************************************************************************************
+//Query server line protocol. Each request is one line of two node indices:
+//
+//    <src> <dest>
+//
+//and each gets exactly one response line, in the order the requests arrived:
+//
+//    <cost> <src> ... <dest>     the travel cost followed by the stops of the path
+//    -1                          dest cannot be reached from src
+//    error <reason>              the line was not a valid query
+//
+//A client may send any number of requests without waiting for the answers.
+//*****************************************************************************************
+
+
+//********************************
+//Query Server Class Header
+//********************************
+//Serves shortest-path queries over TCP from one epoll event loop. The loop reads every
+//connection that has data, parses all the complete request lines it finds, and answers
+//them as one batch on a QueryPool, where queries that share a source share a search.
+//The answers are then appended to each connection's output buffer in request order and
+//sent with a single write per connection. While a batch is being answered, new requests
+//queue up in the kernel and form the next batch, so throughput grows with load while
+//a batch of at most maxBatch queries bounds how long any request waits. A connection
+//whose client stops reading is no longer read from until its output drains.
+class QueryServer{
+	//********************************
+	//Connection Struct Implementation
+	//********************************
+	struct Connection{
+		int fd;                                    //the socket
+		vector<char> in;                           //bytes received but not parsed yet
+		vector<char> out;                          //responses not sent yet
+		size_t sent;                               //bytes of "out" already sent
+		unsigned events;                           //epoll events currently registered
+		bool peerClosed;                           //the client has finished sending
+		bool dead;                                 //closed; freed at the end of the loop turn
+		bool backlog;                              //has complete lines left over for the next batch
+
+		Connection(int socket):fd(socket),sent(0),events(0),peerClosed(false),dead(false),backlog(false){};
+		size_t Unsent() const { return out.size() - sent; }
+	};
+
+	//One parsed request line, in arrival order
+	struct Request{
+		Connection *conn;                          //who asked
+		int query;                                 //index into the batch, or -1 for a bad line
+	};
+
+//**************************************************
+//Query Server Private Data Members and Functions
+//**************************************************
+	Graph &graph;                              //the graph every query runs on (frozen)
+	QueryPool pool;                            //workers that answer each batch
+	int maxBatch;                              //most queries answered together
+	int listenFd;                              //listening socket (-1 until Listen)
+	int epollFd;                               //the event loop's epoll instance
+	int wakeFd;                                //eventfd that Stop() writes to
+	int port;                                  //port actually bound
+	atomic<bool> stopping;                     //set by Stop()
+
+	vector< unique_ptr<Connection> > connections; //every open connection
+	vector<Connection *> backlog;              //connections cut off part way through by a full batch
+	vector<Connection *> starved;              //connections that got nothing into the last batch
+	vector<Connection *> waiting;              //this turn's leftovers, starved ones first
+	vector<Request> requests;                  //the current batch's lines, in order
+	vector<Query> batch;                       //the current batch's valid queries
+	vector<PathResult> answers;                //answers to "batch"
+	vector<Connection *> touched;              //connections that got responses this turn
+	vector<Connection *> finishing;            //clients done sending; closed once answered
+	int closed;                                //connections closed this turn
+	unsigned long long served;                 //requests answered so far
+	unsigned long long batches;                //batches run so far
+
+	static const size_t READ_CHUNK = 64 * 1024;          //bytes asked for per read
+	static const size_t MAX_PENDING_INPUT = 256 * 1024;  //unparsed bytes kept per connection
+	static const size_t MAX_PENDING_OUTPUT = 1 << 20;    //unsent bytes before reading pauses
+	static const size_t MAX_LINE = 256;                  //longest valid request line
+
+	void Accept();                             //accept every waiting connection
+	void Read(Connection &conn);               //drain the socket into conn.in
+	void Parse(Connection &conn);              //turn complete lines into requests
+	void Answer();                             //run the batch and queue the responses
+	void Flush(Connection &conn);              //send as much of conn.out as the socket takes
+	void Close(Connection &conn);              //close the socket; freed at the end of the turn
+	void Watch(Connection &conn);              //register the events conn currently needs
+	void Finish(Connection &conn);             //the client will send nothing more
+	void Reap();                               //free closed connections
+	static void DropDead(vector<Connection *> &list); //forget closed connections in a list
+	void Append(Connection &conn, const PathResult &result);
+	void Append(Connection &conn, const char *text);
+
+//********************************
+//Query Server Public Functions
+//********************************
+public:
+	QueryServer(Graph &g, int threads = 0, int batchLimit = 1024);
+	~QueryServer();
+	QueryServer(const QueryServer &) = delete;
+	QueryServer &operator=(const QueryServer &) = delete;
+	bool Listen(int portNumber, const string &host = "127.0.0.1"); //bind and listen (port 0 picks one)
+	int Port() const { return port; }          //the port being served
+	void Run();                                //serve until Stop() is called
+	void Stop();                               //make Run return; safe from any thread or a signal handler
+	unsigned long long Served() const { return served; }
+	unsigned long long Batches() const { return batches; }
+};
+
+
+//*****************************************************************************************
+//Function:     Query Server constructor / destructor
+//Purpose:      Start the worker pool and the event loop's epoll instance; close every
+//              socket on the way out
+//Incoming:     g: the graph to serve; it must not change while the server exists
+//              threads: pool workers (0 for one per hardware thread)
+//              batchLimit: most queries answered in one batch
+//Outgoing:     A server ready to Listen
+//Return:       N/A
+//*****************************************************************************************
+QueryServer::QueryServer(Graph &g, int threads, int batchLimit)
+	:graph(g),pool(g, threads),maxBatch(max(batchLimit, 1)),listenFd(-1),port(0),stopping(false),closed(0),served(0),batches(0){
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.ptr = &wakeFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+QueryServer::~QueryServer(){
+	for(size_t i = 0; i < connections.size(); i++)
+		if(!connections[i]->dead)
+			close(connections[i]->fd);
+	if(listenFd >= 0)
+		close(listenFd);
+	close(wakeFd);
+	close(epollFd);
+}
+
+
+//*****************************************************************************************
+//Function:     Listen
+//Purpose:      Bind a non-blocking listening socket and add it to the event loop
+//Incoming:     portNumber: the TCP port (0 lets the system pick; see Port())
+//              host: the IPv4 address to bind, loopback by default
+//Outgoing:     The server accepts connections once Run starts
+//Return:       Whether the socket could be bound
+//*****************************************************************************************
+bool QueryServer::Listen(int portNumber, const string &host){
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)portNumber);
+	if(inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1){
+		cerr << "Err: \"" << host << "\" is not an IPv4 address" << endl;
+		return false;
+	}
+
+	listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	int on = 1;
+	setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	if(listenFd < 0 || bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, SOMAXCONN) < 0){
+		cerr << "Err: could not listen on " << host << ":" << portNumber << " (" << strerror(errno) << ")" << endl;
+		return false;
+	}
+	socklen_t length = sizeof(addr);
+	getsockname(listenFd, (sockaddr *)&addr, &length);
+	port = ntohs(addr.sin_port);
+
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.ptr = &listenFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+	return true;
+}
+
+
+//*****************************************************************************************
+//Function:     Run
+//Purpose:      The event loop. Each turn waits for socket events, reads and parses every
+//              ready connection, answers everything parsed as one batch, flushes the
+//              responses, and frees connections that closed. Connections with lines
+//              left over after a full batch are served first next turn, without waiting.
+//Incoming:     N/A
+//Outgoing:     N/A
+//Return:       N/A-void function (returns after Stop)
+//*****************************************************************************************
+void QueryServer::Run(){
+	epoll_event events[64];
+	while(!stopping){
+		int ready = epoll_wait(epollFd, events, 64, backlog.empty() && starved.empty() ? -1 : 0);
+		if(ready < 0 && errno != EINTR){
+			cerr << "Err: epoll_wait failed (" << strerror(errno) << ")" << endl;
+			break;
+		}
+
+		waiting.assign(starved.begin(), starved.end());   //leftover lines go before new ones, and
+		waiting.insert(waiting.end(), backlog.begin(), backlog.end()); //whoever got nothing last time goes first
+		starved.clear();
+		backlog.clear();
+		for(size_t i = 0; i < waiting.size(); i++){
+			waiting[i]->backlog = false;
+			if(!waiting[i]->dead)
+				Parse(*waiting[i]);
+		}
+
+		for(int i = 0; i < ready; i++){
+			void *tag = events[i].data.ptr;
+			if(tag == &listenFd)
+				Accept();
+			else if(tag == &wakeFd){
+				uint64_t count;
+				while(read(wakeFd, &count, sizeof(count)) > 0){}
+			} else{
+				Connection &conn = *(Connection *)tag;
+				if(conn.dead)
+					continue;
+				if(events[i].events & EPOLLOUT)
+					Flush(conn);
+				if(!conn.dead && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))){
+					Read(conn);
+					if(!conn.dead)
+						Parse(conn);
+				}
+			}
+		}
+
+		Answer();
+		Reap();
+	}
+}
+
+
+//Make Run return at the start of its next turn
+void QueryServer::Stop(){
+	stopping = true;
+	uint64_t one = 1;
+	ssize_t written = write(wakeFd, &one, sizeof(one));  //wakes epoll_wait; async-signal-safe
+	(void)written;
+}
+
+
+void QueryServer::Accept(){
+	while(true){
+		int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if(fd < 0)
+			return;                                    //EAGAIN: nobody else is waiting
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));   //responses are already batched
+		connections.push_back(unique_ptr<Connection>(new Connection(fd)));
+		Connection &conn = *connections.back();
+		epoll_event ev;
+		ev.events = conn.events = EPOLLIN;
+		ev.data.ptr = &conn;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Read
+//Purpose:      Move everything the socket has into conn.in, stopping early if too much
+//              unparsed input piles up
+//Incoming:     conn: a connection with data (or a hang-up) waiting
+//Outgoing:     conn.in has grown; peerClosed is set at end of stream
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryServer::Read(Connection &conn){
+	while(conn.in.size() < MAX_PENDING_INPUT){
+		size_t have = conn.in.size();
+		conn.in.resize(have + READ_CHUNK);
+		ssize_t got = recv(conn.fd, &conn.in[have], READ_CHUNK, 0);
+		conn.in.resize(have + (got > 0 ? got : 0));
+		if(got > 0)
+			continue;
+		if(got == 0)
+			Finish(conn);
+		else if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			Close(conn);
+		break;
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Parse
+//Purpose:      Turn the complete lines in conn.in into requests for the current batch.
+//              If the batch fills up, or the connection already has a lot of unsent
+//              output, the rest waits for a later turn.
+//Incoming:     conn: a connection with received bytes
+//Outgoing:     requests / batch have grown; parsed bytes are dropped from conn.in,
+//              and reading resumes if that made room
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryServer::Parse(Connection &conn){
+	size_t pos = 0;
+	size_t first = requests.size();
+	const char *data = conn.in.data();
+	while(pos < conn.in.size()){
+		if((int)batch.size() >= maxBatch || conn.Unsent() >= MAX_PENDING_OUTPUT){
+			if(!conn.backlog && memchr(data + pos, '\n', conn.in.size() - pos)){
+				conn.backlog = true;                   //so one busy client cannot fill every batch
+				(requests.size() == first && conn.Unsent() < MAX_PENDING_OUTPUT ? starved : backlog).push_back(&conn);
+			}
+			break;
+		}
+		const char *nl = (const char *)memchr(data + pos, '\n', conn.in.size() - pos);
+		if(!nl){
+			if(conn.in.size() - pos > MAX_LINE){       //no sane request is this long
+				Append(conn, "error line too long");
+				touched.push_back(&conn);
+				Finish(conn);
+				conn.in.clear();
+				Watch(conn);
+				return;
+			}
+			break;
+		}
+		const char *line = data + pos;
+		const char *end = nl;
+		pos = nl - data + 1;
+
+		while(line < end && (*line == ' ' || *line == '\t'))
+			line++;
+		while(end > line && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+			end--;
+		if(line == end)                                //blank lines get no answer
+			continue;
+
+		int src = -1, dest = -1;
+		from_chars_result first = from_chars(line, end, src);
+		const char *next = first.ptr;
+		while(next < end && (*next == ' ' || *next == '\t'))
+			next++;
+		from_chars_result second = from_chars(next, end, dest);
+		Request request;
+		request.conn = &conn;
+		request.query = -1;
+		if(first.ec == errc() && next > first.ptr && second.ec == errc() && second.ptr == end &&
+		   src >= 0 && src < graph.NumNodes() && dest >= 0 && dest < graph.NumNodes()){
+			request.query = (int)batch.size();
+			batch.push_back(Query(src, dest));
+		}
+		requests.push_back(request);
+	}
+	conn.in.erase(conn.in.begin(), conn.in.begin() + pos);
+	Watch(conn);                               //room in "in" again: resume reading
+}
+
+
+//*****************************************************************************************
+//Function:     Answer
+//Purpose:      Answer the batch on the pool, append every response to its connection in
+//              request order, and give each connection that got responses one write
+//Incoming:     N/A
+//Outgoing:     The batch is empty again
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryServer::Answer(){
+	if(!batch.empty()){
+		pool.Run(batch, answers);
+		batches++;
+	}
+	for(size_t i = 0; i < requests.size(); i++){
+		Connection &conn = *requests[i].conn;
+		if(conn.dead)
+			continue;
+		if(requests[i].query < 0)
+			Append(conn, "error expected \"<src> <dest>\" with valid node indices");
+		else
+			Append(conn, answers[requests[i].query]);
+		if(touched.empty() || touched.back() != &conn)
+			touched.push_back(&conn);
+		served++;
+	}
+	requests.clear();
+	batch.clear();
+
+	for(size_t i = 0; i < touched.size(); i++){     //one write per connection for the whole batch
+		Connection &conn = *touched[i];
+		if(!conn.dead && conn.Unsent() > 0 && !(conn.events & EPOLLOUT))
+			Flush(conn);
+	}
+	touched.clear();
+
+	size_t kept = 0;                                //finished clients close once everything is sent
+	for(size_t i = 0; i < finishing.size(); i++){
+		Connection &conn = *finishing[i];
+		if(conn.dead)
+			continue;
+		if(!conn.backlog && conn.Unsent() == 0)
+			Close(conn);
+		else
+			finishing[kept++] = &conn;
+	}
+	finishing.resize(kept);
+}
+
+
+void QueryServer::Append(Connection &conn, const PathResult &result){
+	if(!result.Found()){
+		Append(conn, "-1");
+		return;
+	}
+	char number[16];
+	to_chars_result r = to_chars(number, number + sizeof(number), result.cost);
+	conn.out.insert(conn.out.end(), number, r.ptr);
+	for(size_t i = 0; i < result.path.size(); i++){
+		r = to_chars(number, number + sizeof(number), result.path[i]);
+		conn.out.push_back(' ');
+		conn.out.insert(conn.out.end(), number, r.ptr);
+	}
+	conn.out.push_back('\n');
+}
+
+void QueryServer::Append(Connection &conn, const char *text){
+	conn.out.insert(conn.out.end(), text, text + strlen(text));
+	conn.out.push_back('\n');
+}
+
+
+//*****************************************************************************************
+//Function:     Flush
+//Purpose:      Send as much pending output as the socket will take. Whatever is left is
+//              sent when epoll reports the socket writable again.
+//Incoming:     conn: a connection with output to send
+//Outgoing:     conn.out shrinks; the connection watches for writability if needed
+//Return:       N/A-void function
+//*****************************************************************************************
+void QueryServer::Flush(Connection &conn){
+	while(conn.Unsent() > 0){
+		ssize_t put = send(conn.fd, &conn.out[conn.sent], conn.Unsent(), MSG_NOSIGNAL);
+		if(put > 0){
+			conn.sent += put;
+			continue;
+		}
+		if(put < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			break;
+		if(put < 0 && errno == EINTR)
+			continue;
+		Close(conn);                                   //the client went away
+		return;
+	}
+	if(conn.Unsent() == 0){
+		conn.out.clear();
+		conn.sent = 0;
+		if(!conn.backlog && memchr(conn.in.data(), '\n', conn.in.size())){
+			conn.backlog = true;                       //lines held back for output can go now
+			backlog.push_back(&conn);
+		}
+	}
+	Watch(conn);
+}
+
+
+//Keep the registered events in line with what the connection needs: input while it
+//has room for more, output while anything is unsent
+void QueryServer::Watch(Connection &conn){
+	unsigned want = 0;
+	if(!conn.peerClosed && conn.in.size() < MAX_PENDING_INPUT && conn.Unsent() < MAX_PENDING_OUTPUT)
+		want |= EPOLLIN;
+	if(conn.Unsent() > 0)
+		want |= EPOLLOUT;
+	if(want == conn.events)
+		return;
+	epoll_event ev;
+	ev.events = conn.events = want;
+	ev.data.ptr = &conn;
+	epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+
+void QueryServer::Finish(Connection &conn){
+	if(conn.peerClosed)
+		return;
+	conn.peerClosed = true;
+	finishing.push_back(&conn);
+}
+
+
+void QueryServer::Close(Connection &conn){
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, conn.fd, NULL);
+	close(conn.fd);
+	conn.dead = true;
+	closed++;
+}
+
+
+//Free the connections closed this turn; nothing refers to them any more
+void QueryServer::Reap(){
+	if(closed == 0)
+		return;
+	closed = 0;
+	DropDead(backlog);
+	DropDead(starved);
+	size_t kept = 0;
+	for(size_t i = 0; i < connections.size(); i++){
+		if(!connections[i]->dead)
+			connections[kept++].swap(connections[i]);
+	}
+	connections.resize(kept);
+}
+
+
+void QueryServer::DropDead(vector<Connection *> &list){
+	size_t kept = 0;
+	for(size_t i = 0; i < list.size(); i++){
+		if(!list[i]->dead)
+			list[kept++] = list[i];
+	}
+	list.resize(kept);
+}
+
+
+#endif
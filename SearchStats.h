@@ -0,0 +1,254 @@
+#ifndef _SEARCHSTATS_H
+#define _SEARCHSTATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+using namespace std;
+
+//*****************************************************************************************
+//Search instrumentation. Building with -DSEARCH_STATS makes every Graph search count its
+//work into its SearchState's "stats": nodes settled, edges scanned, queue pushes, pops and
+//decrease-keys, the largest queue, the wall time, and how much of that time went to the
+//queue. Without the flag STATS_ENABLED is false, every hook sits behind an
+//"if constexpr" or a constant-false test, and the searches compile to exactly the code
+//they were before.
+//*****************************************************************************************
+#ifdef SEARCH_STATS
+constexpr bool STATS_ENABLED = true;
+#else
+constexpr bool STATS_ENABLED = false;
+#endif
+
+
+//Cheap timestamp for timing individual queue operations: the cycle counter where there
+//is one, the steady clock elsewhere. Only ratios of these are ever reported.
+inline uint64_t Ticks(){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+
+//********************************
+//Search Stats Struct
+//********************************
+struct SearchStats{
+	long long settled;                         //nodes taken off the queue and scanned
+	long long relaxed;                         //edges scanned
+	long long pushes;                          //nodes inserted into the queue
+	long long decreaseKeys;                    //queued nodes moved to a smaller distance
+	long long pops;                            //nodes removed from the queue
+	int maxQueue;                              //largest the queue grew
+	uint64_t queueTicks;                       //ticks spent inside queue calls
+	uint64_t totalTicks;                       //ticks for the whole search
+	double wallMicros;                         //wall time of the whole search
+
+	SearchStats(){ Reset(); }
+	void Reset(){
+		settled = relaxed = pushes = decreaseKeys = pops = 0;
+		maxQueue = 0;
+		queueTicks = totalTicks = 0;
+		wallMicros = 0;
+	}
+	void Merge(const SearchStats &other);      //fold in the other half of a two-sided search
+	double QueueShare() const { return totalTicks ? min(1.0, (double)queueTicks / totalTicks) : 0.0; }
+	double QueueMicros() const { return wallMicros * QueueShare(); }          //time in queue operations
+	double ScanMicros() const { return wallMicros - QueueMicros(); }          //time scanning edges and the rest
+	void Print(ostream &out) const;            //one human-readable line
+};
+
+
+void SearchStats::Merge(const SearchStats &other){
+	settled += other.settled;
+	relaxed += other.relaxed;
+	pushes += other.pushes;
+	decreaseKeys += other.decreaseKeys;
+	pops += other.pops;
+	maxQueue = max(maxQueue, other.maxQueue);
+	queueTicks += other.queueTicks;            //both sides ran in the same span of time,
+	totalTicks = max(totalTicks, other.totalTicks);   //so the totals overlap rather than add
+	wallMicros = max(wallMicros, other.wallMicros);
+}
+
+
+void SearchStats::Print(ostream &out) const{
+	out << "Settled " << settled << " nodes, scanned " << relaxed << " edges; queue: "
+	    << pushes << " pushes, " << decreaseKeys << " decrease-keys, " << pops << " pops, peak " << maxQueue
+	    << "; " << wallMicros << " us (" << (int)(QueueShare() * 100 + 0.5) << "% in the queue)" << endl;
+}
+
+
+//********************************
+//Stats Timer Struct
+//********************************
+//Starts a search's stats afresh and times the search for as long as it is in scope.
+//Does nothing at all when STATS_ENABLED is false.
+struct StatsTimer{
+	SearchStats &stats;
+	uint64_t startTicks;
+	chrono::steady_clock::time_point start;
+
+	explicit StatsTimer(SearchStats &s):stats(s),startTicks(0){
+		if(STATS_ENABLED){
+			stats.Reset();
+			start = chrono::steady_clock::now();
+			startTicks = Ticks();
+		}
+	}
+	~StatsTimer(){
+		if(STATS_ENABLED){
+			stats.totalTicks = Ticks() - startTicks;
+			stats.wallMicros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+		}
+	}
+};
+
+
+//********************************
+//Counted Queue Class Header
+//********************************
+//Wraps a search's queue (IndexedPriorityQueue or BucketQueue) and counts and times every
+//call into a SearchStats. The searches are templates on their queue type, so they run on
+//this wrapper unchanged; it only exists in builds with STATS_ENABLED (see Instrumented).
+template<class Queue>
+class CountedQueue{
+	Queue &queue;
+	SearchStats &stats;
+
+public:
+	CountedQueue(Queue &q, SearchStats &s):queue(q),stats(s){};
+	void Enqueue(int index, int dist){
+		uint64_t start = Ticks();
+		if(queue.Contains(index))
+			stats.decreaseKeys++;
+		else
+			stats.pushes++;
+		queue.Enqueue(index, dist);
+		stats.maxQueue = max(stats.maxQueue, queue.Size());
+		stats.queueTicks += Ticks() - start;
+	}
+	int Dequeue(int &distance){
+		uint64_t start = Ticks();
+		int index = queue.Dequeue(distance);
+		if(index != INT_MIN)
+			stats.pops++;
+		stats.queueTicks += Ticks() - start;
+		return index;
+	}
+	int TopDistance() const{
+		uint64_t start = Ticks();
+		int top = queue.TopDistance();
+		stats.queueTicks += Ticks() - start;
+		return top;
+	}
+	bool Empty() const { return queue.Empty(); }
+	int Size() const { return queue.Size(); }
+};
+
+
+//Hand "body" the queue to search with: the bare queue normally, or a CountedQueue around
+//it when stats are compiled in
+template<class Queue, class Body>
+inline void Instrumented(Queue &queue, SearchStats &stats, Body body){
+	if constexpr(STATS_ENABLED){
+		CountedQueue<Queue> counted(queue, stats);
+		body(counted);
+	} else
+		body(queue);
+}
+
+
+//********************************
+//Trace Record Struct
+//********************************
+struct TraceRecord{
+	unsigned long long query;                  //how many queries the tracer had seen before this one
+	int src;                                   //query source
+	int dest;                                  //query destination (-1 for a one-to-many search)
+	SearchStats stats;                         //what the search did
+};
+
+
+//********************************
+//Search Tracer Class Header
+//********************************
+//Keeps the stats of every Nth query in a fixed ring buffer, so a long-running service can
+//be asked what its recent slow queries looked like. Queries that are not sampled cost one
+//atomic increment; sampled ones take a short lock to copy their record in. Once the ring
+//is full each new sample overwrites the oldest.
+class SearchTracer{
+	vector<TraceRecord> ring;                  //the samples, written round-robin
+	unsigned every;                            //sample one query in "every"
+	atomic<unsigned long long> seen;           //queries offered so far
+	mutable mutex lock;                        //guards ring and written
+	unsigned long long written;                //samples taken so far
+
+public:
+	SearchTracer(int capacity = 1024, unsigned sampleEvery = 100);
+	void Record(int src, int dest, const SearchStats &stats); //offer one finished query
+	void Snapshot(vector<TraceRecord> &out) const; //copy the ring out, oldest sample first
+	void Dump(ostream &out) const;             //write the ring as tab-separated lines
+	unsigned long long Seen() const { return seen.load(); }
+};
+
+
+SearchTracer::SearchTracer(int capacity, unsigned sampleEvery)
+	:ring(max(capacity, 1)),every(max(sampleEvery, 1u)),seen(0),written(0){
+}
+
+
+//*****************************************************************************************
+//Function:     Record
+//Purpose:      Offer a finished query to the tracer, which keeps it if it is sampled
+//Incoming:     src / dest: the query (dest -1 for a one-to-many search)
+//              stats: the search's stats
+//Outgoing:     Every Nth query is copied into the ring
+//Return:       N/A-void function
+//*****************************************************************************************
+void SearchTracer::Record(int src, int dest, const SearchStats &stats){
+	unsigned long long query = seen.fetch_add(1, memory_order_relaxed);
+	if(query % every != 0)
+		return;
+	lock_guard<mutex> guard(lock);
+	TraceRecord &slot = ring[written++ % ring.size()];
+	slot.query = query;
+	slot.src = src;
+	slot.dest = dest;
+	slot.stats = stats;
+}
+
+
+void SearchTracer::Snapshot(vector<TraceRecord> &out) const{
+	lock_guard<mutex> guard(lock);
+	size_t count = (size_t)min<unsigned long long>(written, ring.size());
+	out.resize(count);
+	for(size_t i = 0; i < count; i++)
+		out[i] = ring[(written - count + i) % ring.size()];
+}
+
+
+void SearchTracer::Dump(ostream &out) const{
+	vector<TraceRecord> records;
+	Snapshot(records);
+	out << "query\tsrc\tdest\tsettled\tscanned\tpushes\tdecrease_keys\tpops\tmax_queue\twall_us\tqueue_us\tscan_us" << endl;
+	for(size_t i = 0; i < records.size(); i++){
+		const TraceRecord &r = records[i];
+		out << r.query << '\t' << r.src << '\t' << r.dest << '\t' << r.stats.settled << '\t' << r.stats.relaxed << '\t'
+		    << r.stats.pushes << '\t' << r.stats.decreaseKeys << '\t' << r.stats.pops << '\t' << r.stats.maxQueue << '\t'
+		    << r.stats.wallMicros << '\t' << r.stats.QueueMicros() << '\t' << r.stats.ScanMicros() << endl;
+	}
+}
+
+
+#endif
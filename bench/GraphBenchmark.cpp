@@ -0,0 +1,570 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+#include "../ContractionHierarchy.h"
+#include "../DeltaStepping.h"
+#include "../Graph.h"
+#include "../GraphGenerators.h"
+#include "../Heuristics.h"
+using namespace std;
+using namespace std::chrono;
+
+//*****************************************************************************************
+//Usage:        GraphBenchmark [options]
+//
+//              --sizes <n,n,...>     node counts to run (default 1000,10000,100000,1000000)
+//              --families <f,f,...>  any of grid, geometric, scalefree (default all three)
+//              --queries <count>     timed queries per graph and method (default 100)
+//              --methods <m,m,...>   any of dijkstra, dijkstra-heap, bidirectional, astar,
+//                                    alt, ch, delta (default all)
+//              --ch-limit <nodes>    largest graph to build a contraction hierarchy for
+//                                    (default 20000; its preprocessing grows fastest)
+//              --ops <count>         queue operations per microbenchmark (default 2000000)
+//              --sources <count>     timed one-to-all runs per delta-stepping setting (default 5)
+//              --threads <t,t,...>   delta-stepping thread counts (default 1,2,4 and one per core)
+//              --seed <value>        seed for every generator (default 1)
+//              --out <file>          where the JSON report goes (default benchmark.json)
+//              --no-check            skip the reference Dijkstra comparison
+//
+//Runs the queue microbenchmarks, then builds each graph and times random queries with
+//every search method, checking each answer against a deliberately simple reference
+//Dijkstra. Delta-stepping is swept over thread counts and bucket widths, and every one
+//of its one-to-all answers is checked node by node against Graph::Search. Every result
+//in the report carries a stable "id", so two reports can be joined on it to compare
+//runs. The exit status is 1 if any answer was wrong, and 2 if an option was invalid.
+//*****************************************************************************************
+
+
+//********************************
+//Options Struct
+//********************************
+struct Options{
+	vector<int> sizes;                         //node counts to run
+	vector<string> families;                   //generators to run
+	vector<string> methods;                    //search methods to time
+	int chLimit;                               //largest graph the hierarchy is built for
+	int queries;                               //timed queries per graph and method
+	int ops;                                   //queue operations per microbenchmark
+	int sources;                               //one-to-all runs per delta-stepping setting
+	vector<int> threads;                       //delta-stepping thread counts
+	uint64_t seed;                             //generator seed
+	string out;                                //report file
+	bool check;                                //compare answers with the reference?
+
+	Options():chLimit(20000),queries(100),ops(2000000),sources(5),seed(1),out("benchmark.json"),check(true){
+		sizes = {1000, 10000, 100000, 1000000};
+		families = {"grid", "geometric", "scalefree"};
+		methods = {"dijkstra", "dijkstra-heap", "bidirectional", "astar", "alt", "ch", "delta"};
+		threads = {1, 2, 4, ThreadCount(0)};
+		sort(threads.begin(), threads.end());
+		threads.erase(unique(threads.begin(), threads.end()), threads.end());
+	}
+};
+
+
+volatile long long benchmarkSink;          //where the queue checksums go, so the work is kept
+
+
+//One "id" plus named numbers, written out as a JSON object
+struct Record{
+	string id;
+	vector< pair<string, double> > fields;
+};
+
+
+vector<string> Split(const string &list){
+	vector<string> parts;
+	stringstream in(list);
+	string part;
+	while(getline(in, part, ','))
+		if(!part.empty())
+			parts.push_back(part);
+	return parts;
+}
+
+
+double Elapsed(steady_clock::time_point start){
+	return duration<double>(steady_clock::now() - start).count();
+}
+
+
+//*****************************************************************************************
+//Function:     Queue Mix
+//Purpose:      Time one queue on a Dijkstra-like "hold" workload: the queue is kept at a
+//              steady size while every step removes the minimum and inserts a node a
+//              random edge weight further on. A share of the steps also lowers the key of
+//              a random queued node, never below the minimum just removed, so the same
+//              workload is legal for the monotone BucketQueue.
+//Incoming:     q: an empty queue
+//              ops: Enqueue + Dequeue calls to make
+//              decreasePercent: share of steps that also do a decrease-key
+//              maxWeight: largest key step
+//              seed: random seed
+//              sink: receives a checksum so the work cannot be optimised away
+//Outgoing:     N/A
+//Return:       Nanoseconds per queue operation
+//*****************************************************************************************
+template<class Queue>
+double QueueMix(Queue &q, int ops, int decreasePercent, int maxWeight, uint64_t seed, long long &sink){
+	const int held = 10000;                    //queue size during the run
+	SplitMix64 rng(seed);
+	vector<int> key(held * 2), slot(held * 2, -1), queued, spare;
+	for(int i = held * 2 - 1; i >= 0; i--)
+		spare.push_back(i);
+	auto push = [&](int dist){                 //insert a fresh index
+		int index = spare.back();
+		spare.pop_back();
+		key[index] = dist;
+		slot[index] = (int)queued.size();
+		queued.push_back(index);
+		q.Enqueue(index, dist);
+	};
+	for(int i = 0; i < held; i++)
+		push(rng.Between(0, maxWeight));
+
+	int done = 0;
+	auto start = steady_clock::now();
+	while(done < ops){
+		int dist = 0;
+		int index = q.Dequeue(dist);
+		sink += dist;
+		queued[slot[index]] = queued.back();   //forget it in O(1)
+		slot[queued.back()] = slot[index];
+		queued.pop_back();
+		spare.push_back(index);
+		done++;
+		if(rng.Below(100) < decreasePercent){
+			int other = queued[rng.Below((int)queued.size())];
+			key[other] = dist + (key[other] - dist) / 2;
+			q.Enqueue(other, key[other]);
+			done++;
+		}
+		push(dist + rng.Between(1, maxWeight));
+		done++;
+	}
+	double seconds = Elapsed(start);
+	q.Clear();
+	return seconds * 1e9 / done;
+}
+
+
+void RunMicrobenchmarks(const Options &opt, vector<Record> &records){
+	const int maxWeight = 1000;
+	const int mixes[] = {0, 25, 50};
+	long long sink = 0;
+	cout << "Queue microbenchmarks (ns per operation)" << endl;
+	for(int mix : mixes){
+		IndexedPriorityQueue<2> binary;
+		IndexedPriorityQueue<4> quaternary;
+		IndexedPriorityQueue<8> octonary;
+		BucketQueue buckets;
+		buckets.SetSpan(maxWeight);
+		vector< pair<string, double> > results = {
+			{"heap2", QueueMix(binary, opt.ops, mix, maxWeight, opt.seed, sink)},
+			{"heap4", QueueMix(quaternary, opt.ops, mix, maxWeight, opt.seed, sink)},
+			{"heap8", QueueMix(octonary, opt.ops, mix, maxWeight, opt.seed, sink)},
+			{"buckets", QueueMix(buckets, opt.ops, mix, maxWeight, opt.seed, sink)}
+		};
+		for(size_t i = 0; i < results.size(); i++){
+			Record r;
+			r.id = "queue/" + results[i].first + "/decrease" + to_string(mix);
+			r.fields = {{"ns_per_op", results[i].second}, {"ops", (double)opt.ops}};
+			records.push_back(r);
+			printf("  %-32s %8.1f\n", r.id.c_str(), results[i].second);
+		}
+	}
+	benchmarkSink = sink;
+}
+
+
+//*****************************************************************************************
+//Function:     Reference Distance
+//Purpose:      The textbook lazy-deletion Dijkstra on a std::priority_queue. It shares no
+//              code with Graph's searches, which is the point: it is the yardstick every
+//              timed answer is checked against.
+//Incoming:     g: a frozen graph
+//              src / dest: the query
+//              dist: scratch array of NumNodes() entries
+//Outgoing:     N/A
+//Return:       The shortest distance (INT_MAX if unreachable)
+//*****************************************************************************************
+int ReferenceDistance(const Graph &g, int src, int dest, vector<long long> &dist){
+	fill(dist.begin(), dist.end(), LLONG_MAX);
+	priority_queue< pair<long long, int>, vector< pair<long long, int> >, greater< pair<long long, int> > > open;
+	dist[src] = 0;
+	open.push(make_pair(0LL, src));
+	while(!open.empty()){
+		pair<long long, int> top = open.top();
+		open.pop();
+		if(top.first > dist[top.second])
+			continue;
+		if(top.second == dest)
+			return (int)top.first;
+		for(int e = g.Offsets()[top.second]; e < g.Offsets()[top.second + 1]; e++){
+			long long d = top.first + g.Weights()[e];
+			int adj = g.Targets()[e];
+			if(d < dist[adj]){
+				dist[adj] = d;
+				open.push(make_pair(d, adj));
+			}
+		}
+	}
+	return INT_MAX;
+}
+
+
+//Does the path run from src to dest along real edges, adding up to its cost?
+bool ValidPath(const Graph &g, int src, int dest, const PathResult &result){
+	if(!result.Found())
+		return result.path.empty();
+	if(result.path.empty() || result.path.front() != src || result.path.back() != dest)
+		return false;
+	long long total = 0;
+	for(size_t i = 1; i < result.path.size(); i++){
+		int wt = g.EdgeWeight(result.path[i-1], result.path[i]);
+		if(wt == INT_MAX)
+			return false;
+		total += wt;
+	}
+	return total == result.cost;
+}
+
+
+//Value at a percentile of sorted samples (nearest rank)
+double Percentile(const vector<double> &sorted, double p){
+	size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+	return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+
+//One way of answering a query, with the preprocessing it needed
+struct Method{
+	string name;
+	function<void(int, int, PathResult &)> run;
+	double prepSeconds;                        //time to build its tables (0 for none)
+};
+
+
+bool Wanted(const Options &opt, const string &method){
+	return find(opt.methods.begin(), opt.methods.end(), method) != opt.methods.end();
+}
+
+
+//*****************************************************************************************
+//Function:     Run Queries
+//Purpose:      Time random queries on one graph with every search method and check the
+//              answers. Dijkstra runs twice, once on the queue the graph picks and once
+//              forced onto the heap, so the bucket queue is also compared end to end.
+//              Methods that need preprocessing (ALT landmarks, the contraction hierarchy,
+//              delta-stepping's edge split) are built first and their build time is
+//              recorded. The first few queries of each method only warm the scratch
+//              state and are not timed.
+//Incoming:     g: a frozen graph
+//              name: "<family>/<nodes>" for the record ids
+//              x / y: node coordinates for A* (empty if the family has none)
+//              opt: the run's options
+//              records: receives one record per method
+//Outgoing:     N/A
+//Return:       Number of wrong answers
+//*****************************************************************************************
+int RunQueries(Graph &g, const string &name, double buildSeconds, const vector<int> &x, const vector<int> &y,
+               const Options &opt, vector<Record> &records){
+	SearchState fwd, bwd, heap;
+	heap.heapOnly = true;
+	vector<Method> methods;
+	if(Wanted(opt, "dijkstra"))
+		methods.push_back({"dijkstra", [&](int s, int d, PathResult &r){ g.FindPath(s, d, fwd, r); }, 0});
+	if(Wanted(opt, "dijkstra-heap"))
+		methods.push_back({"dijkstra-heap", [&](int s, int d, PathResult &r){ g.FindPath(s, d, heap, r); }, 0});
+	if(Wanted(opt, "bidirectional"))
+		methods.push_back({"bidirectional", [&](int s, int d, PathResult &r){ g.FindPathBidirectional(s, d, fwd, bwd, r); }, 0});
+
+	unique_ptr<CoordinateHeuristic> coords;
+	if(Wanted(opt, "astar") && !x.empty()){
+		auto start = steady_clock::now();
+		coords.reset(new CoordinateHeuristic(g, x, y));
+		methods.push_back({"astar", [&](int s, int d, PathResult &r){ g.FindPathAStar(s, d, *coords, fwd, r); }, Elapsed(start)});
+	}
+	unique_ptr<LandmarkTable> table;
+	unique_ptr<LandmarkHeuristic> landmarks;
+	if(Wanted(opt, "alt")){
+		auto start = steady_clock::now();
+		table.reset(new LandmarkTable(g, 16));
+		landmarks.reset(new LandmarkHeuristic(*table));
+		methods.push_back({"alt", [&](int s, int d, PathResult &r){ g.FindPathAStar(s, d, *landmarks, fwd, r); }, Elapsed(start)});
+	}
+	unique_ptr<ContractionHierarchy> hierarchy;
+	HierarchyState hierarchyState;
+	if(Wanted(opt, "ch") && g.NumNodes() > opt.chLimit)
+		printf("  %-36s skipped (over --ch-limit)\n", ("ch/" + name).c_str());
+	else if(Wanted(opt, "ch")){
+		auto start = steady_clock::now();
+		hierarchy.reset(new ContractionHierarchy(g));
+		methods.push_back({"ch", [&](int s, int d, PathResult &r){ hierarchy->FindPath(s, d, hierarchyState, r); }, Elapsed(start)});
+	}
+	unique_ptr<DeltaStepping> delta;
+	if(Wanted(opt, "delta")){
+		auto start = steady_clock::now();
+		delta.reset(new DeltaStepping(g));
+		methods.push_back({"delta", [&](int s, int d, PathResult &r){ delta->Run(s, fwd); g.BuildPath(s, d, fwd, r); }, Elapsed(start)});
+	}
+
+	SplitMix64 rng(opt.seed ^ 0x5EEDULL);
+	const int warmup = 3;
+	vector< pair<int, int> > queries(opt.queries + warmup);
+	for(size_t i = 0; i < queries.size(); i++)
+		queries[i] = make_pair(rng.Below(g.NumNodes()), rng.Below(g.NumNodes()));
+
+	vector<int> expected(queries.size(), INT_MAX);
+	vector<long long> scratch(opt.check ? g.NumNodes() : 0);
+	for(size_t i = 0; opt.check && i < queries.size(); i++)
+		expected[i] = ReferenceDistance(g, queries[i].first, queries[i].second, scratch);
+
+	int wrong = 0;
+	PathResult result;
+	for(size_t m = 0; m < methods.size(); m++){
+		vector<double> micros;
+		int bad = 0;
+		for(size_t i = 0; i < queries.size(); i++){
+			auto start = steady_clock::now();
+			methods[m].run(queries[i].first, queries[i].second, result);
+			double taken = Elapsed(start) * 1e6;
+			if((int)i >= warmup)
+				micros.push_back(taken);
+			if(opt.check && (result.cost != expected[i] || !ValidPath(g, queries[i].first, queries[i].second, result)))
+				bad++;
+		}
+		sort(micros.begin(), micros.end());
+		double mean = 0;
+		for(size_t i = 0; i < micros.size(); i++)
+			mean += micros[i] / micros.size();
+
+		Record r;
+		r.id = methods[m].name + "/" + name;
+		r.fields = {{"nodes", (double)g.NumNodes()}, {"edges", (double)g.NumEdges()},
+		            {"build_ms", buildSeconds * 1e3}, {"prep_ms", methods[m].prepSeconds * 1e3}, {"queries", (double)micros.size()},
+		            {"mean_us", mean}, {"p50_us", Percentile(micros, 50)}, {"p90_us", Percentile(micros, 90)},
+		            {"p99_us", Percentile(micros, 99)}, {"max_us", micros.back()},
+		            {"checked", opt.check ? (double)queries.size() : 0.0}, {"mismatches", (double)bad}};
+		records.push_back(r);
+		printf("  %-36s p50 %10.1f us  p99 %10.1f us  %s\n", r.id.c_str(), Percentile(micros, 50),
+		       Percentile(micros, 99), !opt.check ? "unchecked" : bad ? "WRONG ANSWERS" : "ok");
+		wrong += bad;
+	}
+	return wrong;
+}
+
+
+//*****************************************************************************************
+//Function:     Run Delta Stepping
+//Purpose:      Time one-to-all delta-stepping on one graph, first at every thread count
+//              with the default bucket width, then at the most threads with the width
+//              scaled from a quarter to four times the default. One-to-all Dijkstra from
+//              the same sources is the baseline, and every delta-stepping answer is
+//              compared with it node by node.
+//Incoming:     g: a frozen graph
+//              name: "<family>/<nodes>" for the record ids
+//              opt: the run's options
+//              records: receives one record per setting
+//Outgoing:     N/A
+//Return:       Number of runs with a wrong distance
+//*****************************************************************************************
+int RunDeltaStepping(Graph &g, const string &name, const Options &opt, vector<Record> &records){
+	SplitMix64 rng(opt.seed ^ 0xDE17AULL);
+	vector<int> sources(opt.sources);
+	for(size_t i = 0; i < sources.size(); i++)
+		sources[i] = rng.Below(g.NumNodes());
+
+	vector<SearchState> expected(sources.size());   //the baseline, and the yardstick
+	double baseline = 0;
+	for(size_t i = 0; i < sources.size(); i++){
+		auto start = steady_clock::now();
+		g.Search(sources[i], NULL, 0, expected[i]);
+		baseline += Elapsed(start) * 1e3 / sources.size();
+	}
+	Record base;
+	base.id = "delta/dijkstra/" + name;
+	base.fields = {{"nodes", (double)g.NumNodes()}, {"mean_ms", baseline}};
+	records.push_back(base);
+	printf("  %-36s mean %9.2f ms\n", base.id.c_str(), baseline);
+
+	int defaultDelta = DeltaStepping(g, 0, 1).Delta();
+	vector< pair<int, int> > settings;         //(threads, delta)
+	for(size_t t = 0; t < opt.threads.size(); t++)
+		settings.push_back(make_pair(opt.threads[t], defaultDelta));
+	const double scales[] = {0.25, 0.5, 2, 4};
+	for(double scale : scales)
+		settings.push_back(make_pair(opt.threads.back(), max(1, (int)(defaultDelta * scale))));
+
+	int wrong = 0;
+	SearchState state;
+	for(size_t k = 0; k < settings.size(); k++){
+		DeltaStepping engine(g, settings[k].second, settings[k].first);
+		engine.Run(sources[0], state);         //warm the buffers
+		double mean = 0;
+		int bad = 0;
+		for(size_t i = 0; i < sources.size(); i++){
+			auto start = steady_clock::now();
+			engine.Run(sources[i], state);
+			mean += Elapsed(start) * 1e3 / sources.size();
+			for(int v = 0; opt.check && v < g.NumNodes(); v++){
+				if(state.Dist(v) != expected[i].Dist(v)){
+					bad++;
+					break;
+				}
+			}
+		}
+
+		Record r;
+		r.id = "delta/threads" + to_string(settings[k].first) + "/delta" + to_string(settings[k].second) + "/" + name;
+		r.fields = {{"nodes", (double)g.NumNodes()}, {"threads", (double)settings[k].first},
+		            {"delta", (double)settings[k].second}, {"runs", (double)sources.size()},
+		            {"mean_ms", mean}, {"speedup", mean > 0 ? baseline / mean : 0.0},
+		            {"checked", opt.check ? (double)sources.size() : 0.0}, {"mismatches", (double)bad}};
+		records.push_back(r);
+		printf("  %-36s mean %9.2f ms  speedup %5.2fx  %s\n", r.id.c_str(), mean, mean > 0 ? baseline / mean : 0.0,
+		       !opt.check ? "unchecked" : bad ? "WRONG ANSWERS" : "ok");
+		wrong += bad;
+	}
+	return wrong;
+}
+
+
+//Build one generated graph of about "nodes" nodes, with coordinates where the family has them
+void Generate(Graph &g, const string &family, int nodes, uint64_t seed, vector<int> &x, vector<int> &y){
+	x.clear();
+	y.clear();
+	if(family == "grid"){
+		int side = max(1, (int)sqrt((double)nodes));
+		MakeGrid(g, side, side, 100, seed);
+		for(int v = 0; v < side * side; v++){  //node r*side + c sits at (c, r)
+			x.push_back(v % side);
+			y.push_back(v / side);
+		}
+	} else if(family == "geometric")
+		MakeGeometric(g, nodes, 6.0, seed, x, y);
+	else
+		MakeScaleFree(g, nodes, 2, 100, seed);
+}
+
+
+void WriteReport(const Options &opt, const vector<Record> &records, int wrong){
+	FILE *out = fopen(opt.out.c_str(), "w");
+	if(!out){
+		cerr << "Err: could not write \"" << opt.out << "\"" << endl;
+		return;
+	}
+	fprintf(out, "{\n  \"schema\": 1,\n  \"seed\": %llu,\n  \"mismatches\": %d,\n  \"results\": [\n",
+	        (unsigned long long)opt.seed, wrong);
+	for(size_t i = 0; i < records.size(); i++){
+		fprintf(out, "    {\"id\": \"%s\"", records[i].id.c_str());
+		for(size_t f = 0; f < records[i].fields.size(); f++)
+			fprintf(out, ", \"%s\": %.6g", records[i].fields[f].first.c_str(), records[i].fields[f].second);
+		fprintf(out, "}%s\n", i + 1 < records.size() ? "," : "");
+	}
+	fprintf(out, "  ]\n}\n");
+	fclose(out);
+	cout << "Report written to " << opt.out << endl;
+}
+
+
+int main(int argc, char *argv[]){
+	Options opt;
+	for(int i = 1; i < argc; i++){
+		string arg = argv[i];
+		if(arg == "--sizes" && i + 1 < argc){
+			opt.sizes.clear();
+			vector<string> parts = Split(argv[++i]);
+			for(size_t k = 0; k < parts.size(); k++){
+				double size = atof(parts[k].c_str());               //accepts 1e6
+				if(!(size >= 1 && size <= INT_MAX)){                 //queries pick nodes at random, so a graph needs one
+					cerr << "Err: graph size \"" << parts[k] << "\" is not a node count of at least 1" << endl;
+					return 2;
+				}
+				opt.sizes.push_back((int)size);
+			}
+		} else if(arg == "--families" && i + 1 < argc)
+			opt.families = Split(argv[++i]);
+		else if(arg == "--methods" && i + 1 < argc)
+			opt.methods = Split(argv[++i]);
+		else if(arg == "--ch-limit" && i + 1 < argc)
+			opt.chLimit = (int)atof(argv[++i]);
+		else if(arg == "--queries" && i + 1 < argc)
+			opt.queries = max(1, atoi(argv[++i]));
+		else if(arg == "--ops" && i + 1 < argc)
+			opt.ops = max(1, atoi(argv[++i]));
+		else if(arg == "--sources" && i + 1 < argc)
+			opt.sources = max(1, atoi(argv[++i]));
+		else if(arg == "--threads" && i + 1 < argc){
+			opt.threads.clear();
+			vector<string> parts = Split(argv[++i]);
+			for(size_t k = 0; k < parts.size(); k++)
+				opt.threads.push_back(max(1, atoi(parts[k].c_str())));
+			if(opt.threads.empty())
+				opt.threads.push_back(1);
+		} else if(arg == "--seed" && i + 1 < argc)
+			opt.seed = strtoull(argv[++i], NULL, 10);
+		else if(arg == "--out" && i + 1 < argc)
+			opt.out = argv[++i];
+		else if(arg == "--no-check")
+			opt.check = false;
+		else{
+			cerr << "Err: unknown option \"" << arg << "\"" << endl;
+			return 2;
+		}
+	}
+	for(size_t f = 0; f < opt.families.size(); f++){
+		if(opt.families[f] != "grid" && opt.families[f] != "geometric" && opt.families[f] != "scalefree"){
+			cerr << "Err: unknown graph family \"" << opt.families[f] << "\"" << endl;
+			return 2;
+		}
+	}
+
+	const vector<string> known = Options().methods;
+	for(size_t m = 0; m < opt.methods.size(); m++){
+		if(find(known.begin(), known.end(), opt.methods[m]) == known.end()){
+			cerr << "Err: unknown search method \"" << opt.methods[m] << "\"" << endl;
+			return 2;
+		}
+	}
+
+	vector<Record> records;
+	RunMicrobenchmarks(opt, records);
+
+	int wrong = 0;
+	cout << "Query latency" << endl;
+	for(size_t f = 0; f < opt.families.size(); f++){
+		for(size_t s = 0; s < opt.sizes.size(); s++){
+			Graph g;
+			vector<int> x, y;
+			auto start = steady_clock::now();
+			Generate(g, opt.families[f], opt.sizes[s], opt.seed, x, y);
+			double build = Elapsed(start);
+			wrong += RunQueries(g, opt.families[f] + "/" + to_string(opt.sizes[s]), build, x, y, opt, records);
+		}
+	}
+
+	cout << "Delta-stepping one-to-all" << endl;
+	for(size_t f = 0; f < opt.families.size(); f++){
+		for(size_t s = 0; s < opt.sizes.size(); s++){
+			Graph g;
+			vector<int> x, y;
+			Generate(g, opt.families[f], opt.sizes[s], opt.seed, x, y);
+			wrong += RunDeltaStepping(g, opt.families[f] + "/" + to_string(opt.sizes[s]), opt, records);
+		}
+	}
+
+	WriteReport(opt, records, wrong);
+	return wrong > 0 ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include "../Graph.h"
+#include "../GraphGenerators.h"
+#include "../AllPairs.h"
+using namespace std;
+
+//*****************************************************************************************
+//Usage:        AllPairsTest
+//
+//Checks DistanceMatrix against one Dijkstra per source for both algorithms, that paths
+//rebuilt from next hops cost what the matrix says, that a matrix computed without next
+//hops refuses to rebuild paths, and that a graph whose distances could reach the
+//UNREACHED sentinel is refused instead of being reported as unreachable. Prints each
+//failed check and exits with status 1 if there was one.
+//*****************************************************************************************
+
+
+int failures = 0;
+
+
+void Check(bool ok, const string &what){
+	if(!ok){
+		cout << "FAILED: " << what << endl;
+		failures++;
+	}
+}
+
+
+void CheckAgainstSearch(Graph &g, AllPairsMethod method, const string &name){
+	DistanceMatrix matrix;
+	Check(matrix.Compute(g, true, method, 2), name + ": compute");
+	SearchState state;
+	PathResult result;
+	int wrong = 0, badPaths = 0;
+	for(int src = 0; src < g.NumNodes(); src++){
+		g.Search(src, NULL, 0, state);
+		for(int dest = 0; dest < g.NumNodes(); dest++){
+			int expected = state.Reached(dest) ? state.distFromSrc[dest] : INT_MAX;
+			wrong += matrix.Dist(src, dest) != expected;
+			if(matrix.FindPath(src, dest, result)){
+				int cost = 0;
+				for(size_t i = 1; i < result.path.size(); i++)
+					cost += g.EdgeWeight(result.path[i-1], result.path[i]);
+				badPaths += result.path.back() != dest || cost != expected;
+			}
+		}
+	}
+	Check(wrong == 0, name + ": distances match Dijkstra (" + to_string(wrong) + " differ)");
+	Check(badPaths == 0, name + ": next-hop paths cost their distance (" + to_string(badPaths) + " do not)");
+}
+
+
+int main(){
+	for(unsigned long long seed = 1; seed <= 3; seed++){
+		SplitMix64 rng(seed);
+		Graph g(150);
+		for(int e = 0; e < 600; e++)
+			g.AddAdj(rng.Below(150), rng.Between(0, 50), rng.Below(150));
+		g.Freeze();
+		CheckAgainstSearch(g, ALLPAIRS_FLOYD_WARSHALL, "Floyd-Warshall seed " + to_string(seed));
+		CheckAgainstSearch(g, ALLPAIRS_DIJKSTRA, "repeated Dijkstra seed " + to_string(seed));
+	}
+
+	Graph small(3);
+	small.AddAdj(0, 5, 1);
+	small.AddAdj(1, 6, 2);
+	DistanceMatrix distancesOnly;
+	Check(distancesOnly.Compute(small), "computing distances only");
+	Check(distancesOnly.Dist(0, 2) == 11, "distance without next hops");
+	PathResult result;
+	result.path.assign(4, 7);
+	Check(!distancesOnly.FindPath(0, 2, result), "FindPath refuses without next hops");
+	Check(result.path.empty() && !result.Found(), "FindPath leaves an empty result without next hops");
+
+	Graph heavy(2);                             //one edge as heavy as the sentinel
+	heavy.AddAdj(0, DistanceMatrix::UNREACHED, 1);
+	DistanceMatrix refused;
+	Check(!refused.Compute(heavy, true), "refusing an edge that reaches UNREACHED");
+	Check(refused.NumNodes() == 0, "a refused matrix is empty");
+
+	Graph chain(4);                             //no single heavy edge, but a long path
+	for(int i = 0; i < 3; i++)
+		chain.AddAdj(i, 400000000, i + 1);
+	Check(!refused.Compute(chain), "refusing a path that reaches UNREACHED");
+
+	Graph justBelow(3);
+	justBelow.AddAdj(0, DistanceMatrix::UNREACHED / 2, 1);
+	justBelow.AddAdj(1, DistanceMatrix::UNREACHED / 2 - 1, 2);
+	DistanceMatrix accepted;
+	Check(accepted.Compute(justBelow, true), "accepting paths just below UNREACHED");
+	Check(accepted.Dist(0, 2) == DistanceMatrix::UNREACHED - 2, "distance just below UNREACHED");
+
+	if(failures == 0)
+		cout << "All all-pairs checks passed." << endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Graph.h"
+#include "../GraphGenerators.h"
+#include "../DynamicSSSP.h"
+using namespace std;
+
+//*****************************************************************************************
+//Usage:        DynamicSSSPTest
+//
+//Applies random weight changes, removals and insertions to several graphs and, after
+//every single one, compares the repaired DynamicSSSP tree with a full Graph::Search and
+//the graph's edges with a simple model of what they should be. Prints the first failure
+//of each run and exits with status 1 if there was one.
+//*****************************************************************************************
+
+
+int failures = 0;
+
+
+bool Check(bool ok, const string &what){
+	if(!ok){
+		cout << "FAILED: " << what << endl;
+		failures++;
+	}
+	return ok;
+}
+
+
+typedef map< pair<int, int>, vector<int> > EdgeModel;   //(from, to) -> weight of every parallel edge
+
+
+//Does the tree match a fresh search, with every parent edge tight? Does the graph match the model?
+bool Matches(const Graph &g, const DynamicSSSP &tree, const EdgeModel &model, SearchState &state, const string &where){
+	g.Search(tree.Source(), NULL, 0, state);
+	for(int v = 0; v < g.NumNodes(); v++){
+		if(!Check(tree.Dist(v) == state.Dist(v), where + ": distance of node " + to_string(v)))
+			return false;
+		if(v == tree.Source() || tree.Dist(v) == INT_MAX)
+			continue;
+		int p = tree.Parent(v);
+		if(!Check(p >= 0 && g.EdgeWeight(p, v) != INT_MAX && tree.Dist(p) + g.EdgeWeight(p, v) == tree.Dist(v), where + ": parent of node " + to_string(v)))
+			return false;
+	}
+	int edges = 0;
+	for(EdgeModel::const_iterator it = model.begin(); it != model.end(); ++it){
+		int best = INT_MAX;
+		for(size_t k = 0; k < it->second.size(); k++)
+			best = min(best, it->second[k]);
+		edges += (int)it->second.size();
+		if(!Check(g.EdgeWeight(it->first.first, it->first.second) == best, where + ": weight of edge " + to_string(it->first.first) + "->" + to_string(it->first.second)))
+			return false;
+	}
+	return Check(g.NumEdges() == edges, where + ": edge count");
+}
+
+
+//*****************************************************************************************
+//Function:     Run
+//Purpose:      One randomized run: "steps" changes to g, each followed by a full check
+//Incoming:     g: a frozen graph whose edges are listed in model
+//              model: every edge of g
+//              maxWeight: largest weight to draw (0 is allowed)
+//              steps: number of changes
+//              seed: random seed
+//              name: what to call this run in failure messages
+//Outgoing:     g and model have changed alike
+//Return:       N/A-void function
+//*****************************************************************************************
+void Run(Graph &g, EdgeModel &model, int maxWeight, int steps, uint64_t seed, const string &name){
+	SplitMix64 rng(seed);
+	DynamicSSSP tree(g, rng.Below(g.NumNodes()));
+	SearchState state;
+	vector< pair<int, int> > known;
+	for(EdgeModel::iterator it = model.begin(); it != model.end(); ++it)
+		known.push_back(it->first);
+	if(!Matches(g, tree, model, state, name + " at the start"))
+		return;
+
+	for(int step = 0; step < steps; step++){
+		pair<int, int> e = known[rng.Below((int)known.size())];
+		EdgeModel::iterator it = model.find(e);
+		int kind = rng.Below(10);
+		string what;
+		if(kind < 5){                              //reweight, up or down
+			int wt = rng.Between(0, maxWeight);
+			bool exists = it != model.end();
+			Check(tree.UpdateWeight(e.first, e.second, wt) == exists, name + ": UpdateWeight result");
+			if(exists)
+				it->second.assign(it->second.size(), wt);
+			what = "UpdateWeight";
+		} else if(kind < 8){                       //remove every parallel edge
+			bool exists = it != model.end();
+			Check(tree.RemoveEdge(e.first, e.second) == exists, name + ": RemoveEdge result");
+			if(exists)
+				model.erase(it);
+			what = "RemoveEdge";
+		} else{                                    //insert, sometimes a self-loop
+			int from = rng.Below(g.NumNodes());
+			int to = rng.Below(4) == 0 ? from : rng.Below(g.NumNodes());
+			int wt = rng.Between(0, maxWeight);
+			g.AddAdj(from, wt, to);
+			g.Freeze();
+			tree.EdgeChanged(from, to);
+			model[make_pair(from, to)].push_back(wt);
+			known.push_back(make_pair(from, to));
+			e = make_pair(from, to);
+			what = "AddAdj";
+		}
+		if(!Matches(g, tree, model, state, name + " after step " + to_string(step) + " (" + what + " " + to_string(e.first) + "->" + to_string(e.second) + ")"))
+			return;
+	}
+}
+
+
+//A random directed graph with zero weights, parallel edges and self-loops
+void RandomGraph(Graph &g, EdgeModel &model, int nodes, int edges, int maxWeight, uint64_t seed){
+	SplitMix64 rng(seed);
+	g.Resize(nodes);
+	for(int i = 0; i < edges; i++){
+		int from = rng.Below(nodes);
+		int to = rng.Below(10) == 0 ? from : rng.Below(nodes);
+		int wt = rng.Between(0, maxWeight);
+		g.AddAdj(from, wt, to);
+		model[make_pair(from, to)].push_back(wt);
+	}
+	g.Freeze();
+}
+
+
+int main(){
+	{                                              //zero-weight self-loops are real edges, not removal marks
+		Graph g;
+		g.AddAdj(0, 0, 0);
+		g.AddAdj(0, 4, 1);
+		g.AddAdj(1, 2, 2);
+		g.Freeze();
+		g.RemoveEdge(1, 2);
+		g.Freeze();
+		Check(g.NumEdges() == 2, "self-loop kept by Freeze after a removal");
+		Check(g.EdgeWeight(0, 0) == 0, "weight of the kept self-loop");
+		g.RemoveEdge(0, 0);
+		Check(g.EdgeWeight(0, 0) == INT_MAX && g.NumEdges() == 1, "self-loop removed");
+		g.Freeze();
+		Check(g.EdgeWeight(0, 0) == INT_MAX && g.NumEdges() == 1 && g.EdgeWeight(0, 1) == 4, "graph after removing the self-loop");
+		g.RemoveEdge(0, 1);
+		Check(!g.UpdateWeight(0, 0, 7) && g.EdgeWeight(0, 0) == INT_MAX, "a removed edge stays removed");
+	}
+
+	for(uint64_t seed = 1; seed <= 4; seed++){
+		Graph g;
+		EdgeModel model;
+		RandomGraph(g, model, 300, 1200, seed % 2 ? 9 : 1000, seed);
+		Run(g, model, seed % 2 ? 9 : 1000, 1500, seed * 7919, "random graph " + to_string(seed));
+	}
+	{
+		Graph g;
+		MakeGrid(g, 20, 20, 50, 3);
+		EdgeModel model;
+		for(int u = 0; u < g.NumNodes(); u++)
+			for(int e = g.Offsets()[u]; e < g.Offsets()[u+1]; e++)
+				model[make_pair(u, g.Targets()[e])].push_back(g.Weights()[e]);
+		Run(g, model, 50, 1500, 17, "grid");
+	}
+
+	if(failures == 0)
+		cout << "All dynamic SSSP checks passed." << endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <iostream>
+#include "../Graph.h"
+#include "../GraphLoader.h"
+using namespace std;
+
+//*****************************************************************************************
+//Usage:        LoaderTest [scratch file]
+//
+//Checks that ChunkReader::NextInt reads numbers at the edges of the int range, including
+//ones split across buffer refills, and that it rejects anything larger instead of
+//wrapping it into a different number, so LoadGraph fails on such a file. Header counts
+//too large to index or allocate must fail the load too, not abort it. Prints each failed
+//check and exits with status 1 if there was one.
+//*****************************************************************************************
+
+
+int failures = 0;
+
+
+void Check(bool ok, const string &what){
+	if(!ok){
+		cout << "FAILED: " << what << endl;
+		failures++;
+	}
+}
+
+
+void WriteFile(const string &path, const string &text){
+	FILE *file = fopen(path.c_str(), "wb");
+	Check(file && fwrite(text.data(), 1, text.size(), file) == text.size(), "writing " + path);
+	if(file)
+		fclose(file);
+}
+
+
+bool Loads(const string &path, const string &text){
+	WriteFile(path, text);
+	Graph graph;
+	return LoadGraph(path, "", graph);
+}
+
+
+int main(int argc, char *argv[]){
+	const string path = argc > 1 ? argv[1] : "LoaderTest.txt";
+
+	WriteFile(path, "2147483647 -2147483648 0 -0 12\n2147483648 -2147483649 99999999999999999999999 7");
+	ChunkReader reader(path, 4);                //tiny chunks so numbers straddle refills
+	int value = 0;
+	Check(reader.NextInt(value) && value == INT_MAX, "reading INT_MAX");
+	Check(reader.NextInt(value) && value == INT_MIN, "reading INT_MIN");
+	Check(reader.NextInt(value) && value == 0, "reading 0");
+	Check(reader.NextInt(value) && value == 0, "reading -0");
+	Check(reader.NextInt(value) && value == 12 && !reader.Overflowed(), "reading 12");
+	Check(!reader.NextInt(value) && reader.Overflowed(), "rejecting INT_MAX + 1");
+	Check(!reader.NextInt(value) && reader.Overflowed(), "rejecting INT_MIN - 1");
+	Check(!reader.NextInt(value) && reader.Overflowed(), "rejecting a number too large for a long long");
+	Check(reader.NextInt(value) && value == 7 && !reader.Overflowed(), "reading on after a rejected number");
+	Check(!reader.NextInt(value) && !reader.Overflowed(), "end of file is not an overflow");
+
+	Check(Loads(path, "3 2\n0 1 2147483647\n1 2 5\n"), "loading a weight of INT_MAX");
+	Check(!Loads(path, "3 2\n0 1 2147483648\n1 2 5\n"), "rejecting a weight of INT_MAX + 1");
+	Check(!Loads(path, "3 2\n0 1 4294967301\n1 2 5\n"), "rejecting a weight that wraps to 5");
+	Check(!Loads(path, "3 2\n4294967296 1 1\n1 2 5\n"), "rejecting a node that wraps to 0");
+	Check(!Loads(path, "4294967299 2\n0 1 1\n1 2 5\n"), "rejecting a node count that wraps to 3");
+	Check(!Loads(path, "2147483647 1\n0 1 1\n"), "rejecting a node count of INT_MAX");
+	Check(!Loads(path, "1500000000 1\n0 1 1\n"), "rejecting a node count too large to allocate");
+	Check(!Loads(path, "3 2000000000\n0 1 1\n"), "rejecting an edge count the file cannot hold");
+	Check(Loads(path, "0 0\n"), "loading an empty graph");
+	remove(path.c_str());
+
+	if(failures == 0)
+		cout << "All loader checks passed." << endl;
+	return failures == 0 ? 0 : 1;
+}
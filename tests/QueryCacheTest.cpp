@@ -0,0 +1,83 @@
+#include <iostream>
+#include "../Graph.h"
+#include "../QueryCache.h"
+using namespace std;
+
+//*****************************************************************************************
+//Usage:        QueryCacheTest
+//
+//Checks that a QueryCache never answers from a graph version it has outlived: edges
+//added with AddAdj, reweighted or removed must all show up in the next lookup, including
+//lookups made while added edges were still waiting for Freeze. Nodes added with AddNode
+//or Resize must be searchable at once, even from a cache sized for fewer nodes. Prints
+//each failed check and exits with status 1 if there was one.
+//*****************************************************************************************
+
+
+int failures = 0;
+
+
+void Check(bool ok, const string &what){
+	if(!ok){
+		cout << "FAILED: " << what << endl;
+		failures++;
+	}
+}
+
+
+int Cost(QueryCache &cache, int src, int dest){
+	SearchState state;
+	PathResult result;
+	cache.FindPath(src, dest, state, result);
+	return result.cost;
+}
+
+
+int main(){
+	Graph g;
+	g.AddAdj(0, 10, 1);
+	g.AddAdj(1, 10, 2);
+	g.AddAdj(0, 20, 2);
+	QueryCache cache(g);
+	Check(Cost(cache, 0, 2) == 20, "first answer");
+	Check(Cost(cache, 0, 2) == 20, "repeated answer");
+
+	g.AddAdj(0, 1, 2);                          //not searchable until Freeze...
+	Check(Cost(cache, 0, 2) == 20, "lookup with the new edge still pending");
+	g.Freeze();                                 //...so the answer cached just now is stale
+	Check(Cost(cache, 0, 2) == 1, "lookup after Freeze packs the new edge");
+
+	g.UpdateWeight(0, 2, 30);
+	Check(Cost(cache, 0, 2) == 20, "lookup after UpdateWeight");
+	g.RemoveEdge(0, 2);
+	Check(Cost(cache, 0, 2) == 20, "lookup after RemoveEdge");
+	g.RemoveEdge(0, 1);
+	Check(Cost(cache, 0, 2) == INT_MAX, "lookup after cutting the only path");
+
+	for(int i = 0; i < 8; i++)                  //make 0 a hot source so its whole tree is cached
+		Cost(cache, 0, 1);
+	g.AddAdj(0, 5, 1);
+	g.Freeze();
+	Check(Cost(cache, 0, 2) == 15, "tree lookup after Freeze packs a new edge");
+
+	Graph grown;                                //per-source state is sized by the node count
+	grown.AddNode("a");
+	grown.AddNode("b");
+	grown.AddAdj(0, 3, 1);
+	grown.Freeze();
+	QueryCache small(grown, 8, 2, 1);
+	Check(Cost(small, 0, 1) == 3, "lookup before the graph grows");
+	grown.AddNode("c");                         //no edges, so nothing else moves the version
+	Check(Cost(small, 0, 2) == INT_MAX, "lookup to a node added after caching a tree");
+	Check(Cost(small, 2, 0) == INT_MAX, "lookup from a node added after caching a tree");
+	grown.Resize(5);
+	Check(Cost(small, 0, 4) == INT_MAX, "lookup to a node added by Resize");
+	Check(Cost(small, 4, 0) == INT_MAX, "lookup from a node added by Resize");
+	grown.AddAdj(1, 4, 4);
+	grown.Freeze();
+	Check(Cost(small, 0, 4) == 7, "lookup over an edge to a grown node");
+
+	if(failures == 0)
+		cout << "All query cache checks passed." << endl;
+	return failures == 0 ? 0 : 1;
+}
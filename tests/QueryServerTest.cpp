@@ -0,0 +1,159 @@
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Graph.h"
+#include "../GraphGenerators.h"
+#include "../QueryServer.h"
+using namespace std;
+
+//*****************************************************************************************
+//Usage:        QueryServerTest
+//
+//Serves a generated grid on a loopback port and checks that pipelined requests from
+//several connections at once are all answered, in order, with the same costs a direct
+//search gives, that malformed lines get error replies, that no connection waits behind
+//the others, and that a client which sends more blank lines than the server buffers is
+//still answered. Prints each failed check
+//and exits with status 1 if there was one.
+//*****************************************************************************************
+
+
+atomic<int> failures(0);
+mutex output;                                  //client threads check at the same time
+
+
+void Check(bool ok, const string &what){
+	if(!ok){
+		lock_guard<mutex> guard(output);
+		cout << "FAILED: " << what << endl;
+		failures++;
+	}
+}
+
+
+//Connect to the server, giving up on any read that waits more than ten seconds
+int Connect(int port){
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)port);
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+	timeval wait = {10, 0};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait));
+	if(connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0){
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+
+//Send "request" from a second thread while reading every reply, then return the replies
+string Exchange(int fd, const string &request, bool hangUp){
+	thread writer([&]{
+		for(size_t sent = 0; sent < request.size(); ){
+			ssize_t put = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+			if(put <= 0)
+				break;
+			sent += put;
+		}
+		if(hangUp)
+			shutdown(fd, SHUT_WR);
+	});
+	string replies;
+	char buffer[65536];
+	ssize_t got;
+	while((got = recv(fd, buffer, sizeof(buffer), 0)) > 0){
+		replies.append(buffer, got);
+		if(!hangUp && !replies.empty() && replies.back() == '\n')
+			break;                                  //one reply wanted
+	}
+	writer.join();
+	return replies;
+}
+
+
+//One client: pipeline "count" random queries (and a few bad lines) and check every reply
+void Client(const Graph &g, int port, int id, int count){
+	int fd = Connect(port);
+	Check(fd >= 0, "connect");
+	if(fd < 0)
+		return;
+	SplitMix64 rng(id + 1);
+	vector<Query> queries;
+	string request;
+	for(int i = 0; i < count; i++){
+		Query q(rng.Below(g.NumNodes()), rng.Below(g.NumNodes()));
+		queries.push_back(q);
+		request += to_string(q.src) + " " + to_string(q.dest) + (i % 2 ? "\r\n" : "\n");
+		if(i % 500 == 7){
+			request += "not a query\n\n";
+			queries.push_back(Query(-1, -1));
+		}
+	}
+	stringstream replies(Exchange(fd, request, true));
+	close(fd);
+
+	SearchState state;
+	PathResult result;
+	string line;
+	size_t answered = 0;
+	for(; answered < queries.size() && getline(replies, line); answered++){
+		const Query &q = queries[answered];
+		if(q.src < 0){
+			Check(line.compare(0, 5, "error") == 0, "error reply to a bad line");
+			continue;
+		}
+		g.FindPath(q.src, q.dest, state, result);
+		stringstream fields(line);
+		int cost = 0, first = -1, last = -1, node;
+		fields >> cost;
+		while(fields >> node){
+			if(first < 0)
+				first = node;
+			last = node;
+		}
+		if(!result.Found())
+			Check(cost == -1, "unreachable reply");
+		else
+			Check(cost == result.cost && first == q.src && last == q.dest, "reply to " + to_string(q.src) + " " + to_string(q.dest));
+	}
+	Check(answered == queries.size() && !getline(replies, line), "one reply per request");
+}
+
+
+int main(){
+	Graph g;
+	MakeGrid(g, 60, 60, 100, 1);
+	QueryServer server(g, 4, 256);
+	if(!server.Listen(0)){
+		cout << "FAILED: listen" << endl;
+		return 1;
+	}
+	thread loop([&]{ server.Run(); });
+
+	vector<thread> clients;
+	for(int id = 0; id < 6; id++)
+		clients.push_back(thread(Client, cref(g), server.Port(), id, 1000));
+	for(size_t i = 0; i < clients.size(); i++)
+		clients[i].join();
+
+	int fd = Connect(server.Port());            //more blank lines than the server buffers
+	string flood(400000, '\n');
+	string reply = Exchange(fd, flood + "0 99\n", false);
+	PathResult result;
+	SearchState state;
+	g.FindPath(0, 99, state, result);
+	Check(reply.compare(0, reply.find(' '), to_string(result.cost)) == 0, "reply after a flood of blank lines");
+	close(fd);
+
+	server.Stop();
+	loop.join();
+	if(failures == 0)
+		cout << "All query server checks passed (" << server.Served() << " requests in " << server.Batches() << " batches)." << endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+#include <cstdio>
+#include <iostream>
+#include "../Graph.h"
+#include "../GraphSnapshot.h"
+using namespace std;
+
+//*****************************************************************************************
+//Usage:        SnapshotTest [scratch file]
+//
+//Saves snapshots with and without names (and an empty graph, whose sections are all
+//empty), maps them back, and checks that LoadSnapshot rejects headers whose checksum is
+//valid but whose counts or section positions would read outside the file. With payload
+//verification, checksummed sections whose offsets, node indices or weights are out of
+//range are rejected too. Prints each failed check and exits with status 1 if there was
+//one.
+//*****************************************************************************************
+
+
+int failures = 0;
+
+
+void Check(bool ok, const string &what){
+	if(!ok){
+		cout << "FAILED: " << what << endl;
+		failures++;
+	}
+}
+
+
+//*****************************************************************************************
+//Function:     Rewrite Header
+//Purpose:      Change a snapshot's header and re-seal it with a valid checksum, the way a
+//              buggy or hostile writer could
+//Incoming:     path: the snapshot
+//              change: callable that edits the header
+//Outgoing:     The snapshot's header is replaced
+//Return:       N/A-void function
+//*****************************************************************************************
+template<class Change>
+void RewriteHeader(const string &path, Change change){
+	FILE *file = fopen(path.c_str(), "r+b");
+	SnapshotHeader header;
+	if(!file || fread(&header, sizeof(header), 1, file) != 1){
+		Check(false, "reading the header of " + path);
+		if(file)
+			fclose(file);
+		return;
+	}
+	change(header);
+	header.headerChecksum = Checksum(&header, offsetof(SnapshotHeader, headerChecksum));
+	fseek(file, 0, SEEK_SET);
+	Check(fwrite(&header, sizeof(header), 1, file) == 1, "rewriting the header of " + path);
+	fclose(file);
+}
+
+
+//*****************************************************************************************
+//Function:     Patch Payload
+//Purpose:      Overwrite one int of a snapshot section, optionally re-sealing the payload
+//              checksum so that only the range checks can notice
+//Incoming:     path: the snapshot
+//              section: which section's position to use
+//              index / value: the int to overwrite and its new value
+//              reseal: recompute the payload checksum afterwards
+//Outgoing:     The snapshot is changed
+//Return:       N/A-void function
+//*****************************************************************************************
+void PatchPayload(const string &path, uint64_t SnapshotHeader::*section, int index, int value, bool reseal){
+	FILE *file = fopen(path.c_str(), "r+b");
+	SnapshotHeader header;
+	if(!file || fread(&header, sizeof(header), 1, file) != 1){
+		Check(false, "reading the header of " + path);
+		if(file)
+			fclose(file);
+		return;
+	}
+	vector<char> payload(header.fileSize - sizeof(header));
+	Check(fread(payload.data(), 1, payload.size(), file) == payload.size(), "reading the payload of " + path);
+	memcpy(&payload[header.*section - sizeof(header) + sizeof(int) * index], &value, sizeof(int));
+	if(reseal){
+		header.payloadChecksum = Checksum(payload.data(), payload.size());
+		header.headerChecksum = Checksum(&header, offsetof(SnapshotHeader, headerChecksum));
+	}
+	fseek(file, 0, SEEK_SET);
+	Check(fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(payload.data(), 1, payload.size(), file) == payload.size(),
+	      "rewriting " + path);
+	fclose(file);
+}
+
+
+void CheckVerifyRejects(Graph &original, const string &path, const string &what,
+                        uint64_t SnapshotHeader::*section, int index, int value, bool reseal = true){
+	Check(SaveSnapshot(original, path), "saving before corrupting " + what);
+	PatchPayload(path, section, index, value, reseal);
+	Graph loaded;
+	Check(!LoadSnapshot(path, loaded, true), "verification rejecting " + what);
+}
+
+
+template<class Change>
+void CheckRejected(Graph &original, const string &path, const string &what, Change change){
+	Check(SaveSnapshot(original, path), "saving before corrupting " + what);
+	RewriteHeader(path, change);
+	Graph loaded;
+	Check(!LoadSnapshot(path, loaded), "rejecting " + what);
+}
+
+
+int main(int argc, char *argv[]){
+	const string path = argc > 1 ? argv[1] : "SnapshotTest.snap";
+
+	Graph empty;
+	Check(SaveSnapshot(empty, path), "saving an empty graph");
+	Graph emptyLoaded;
+	Check(LoadSnapshot(path, emptyLoaded, true), "loading an empty graph");
+	Check(emptyLoaded.NumNodes() == 0 && emptyLoaded.NumEdges() == 0, "empty graph size");
+
+	Graph plain;                                //numbered nodes only, so the name text is empty
+	for(int i = 0; i < 50; i++)
+		plain.AddAdj(i, i + 1, (i * 7 + 3) % 50);
+	Check(SaveSnapshot(plain, path), "saving a graph without names");
+	Graph plainLoaded;
+	Check(LoadSnapshot(path, plainLoaded, true), "loading a graph without names");
+	Check(plainLoaded.NumEdges() == plain.NumEdges(), "edge count without names");
+	Check(plainLoaded.EdgeWeight(10, 23) == 11, "edge weight without names");
+
+	Graph named;
+	named.AddNode("alpha");
+	named.AddNode("beta");
+	named.AddNode("gamma");
+	named.AddAdj(0, 4, 1);
+	named.AddAdj(1, 6, 2);
+	Check(SaveSnapshot(named, path), "saving a graph with names");
+	Graph namedLoaded;
+	Check(LoadSnapshot(path, namedLoaded, true), "loading a graph with names");
+	Check(namedLoaded.GetName(2) == "gamma", "name after loading");
+	Check(namedLoaded.EdgeWeight(1, 2) == 6, "edge weight with names");
+
+	CheckRejected(plain, path, "a negative node count", [](SnapshotHeader &h){ h.nodes = -1; });
+	CheckRejected(plain, path, "a node count past the file", [](SnapshotHeader &h){ h.nodes = 1 << 30; });
+	CheckRejected(plain, path, "a smaller node count", [](SnapshotHeader &h){ h.nodes = 10; });
+	CheckRejected(plain, path, "a smaller edge count", [](SnapshotHeader &h){ h.edges = 10; });
+	CheckRejected(plain, path, "a section past the file", [](SnapshotHeader &h){ h.targetsPos = h.fileSize; });
+	CheckRejected(plain, path, "a section position that overflows", [](SnapshotHeader &h){ h.weightsPos = ~(uint64_t)63; });
+	CheckRejected(plain, path, "a section inside the header", [](SnapshotHeader &h){ h.offsetsPos = 0; });
+	CheckRejected(plain, path, "a misaligned section", [](SnapshotHeader &h){ h.revSourcesPos += 2; });
+	CheckRejected(named, path, "name bytes past the file", [](SnapshotHeader &h){ h.nameBytes += 100; });
+	CheckRejected(named, path, "name bytes short of the offsets", [](SnapshotHeader &h){ h.nameBytes -= 1; });
+
+	int edges = plain.NumEdges();
+	CheckVerifyRejects(plain, path, "a flipped weight", &SnapshotHeader::weightsPos, 3, 12345, false);
+	CheckVerifyRejects(plain, path, "a target past the last node", &SnapshotHeader::targetsPos, 7, 50);
+	CheckVerifyRejects(plain, path, "a negative reverse source", &SnapshotHeader::revSourcesPos, 0, -1);
+	CheckVerifyRejects(plain, path, "offsets that go backwards", &SnapshotHeader::offsetsPos, 1, edges);
+	CheckVerifyRejects(plain, path, "reverse offsets that do not start at 0", &SnapshotHeader::revOffsetsPos, 0, 1);
+	CheckVerifyRejects(plain, path, "a weight above the header's bound", &SnapshotHeader::weightsPos, 0, plain.MaxWeight() + 1);
+	CheckVerifyRejects(plain, path, "an unflagged negative weight", &SnapshotHeader::revWeightsPos, 0, -5);
+	CheckVerifyRejects(named, path, "name offsets that go backwards", &SnapshotHeader::nameOffsetsPos, 1, 14);
+	remove(path.c_str());
+
+	if(failures == 0)
+		cout << "All snapshot checks passed." << endl;
+	return failures == 0 ? 0 : 1;
+}